@@ -0,0 +1,503 @@
+#include "api_auth.h"
+#include "web_server.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "mbedtls/md.h"
+#include "mbedtls/sha256.h"
+
+static const char *TAG = "API_AUTH";
+
+#define API_AUTH_KEYS_NVS_KEY "keys2"
+// 이전 형식 (검증 해시만 저장, 서명/UDP MAC 키 없음)
+#define API_AUTH_LEGACY_NVS_KEY "keys"
+#define DEFAULT_KEY_ID        "default"
+
+// 서명 대상 문자열 최대 길이 (메서드 + URI(httpd 최대 512) + 부팅 ID + nonce + 묶인 헤더 3개)
+#define SIGNED_MESSAGE_MAX    800
+
+// 서명/UDP MAC 키 유도용 라벨: MAC 키 = HMAC-SHA256(키 원문, "mac")
+#define MAC_KEY_LABEL         "mac"
+
+// NVS 저장 형식 (배열로 저장, 개수는 blob 크기로 계산)
+typedef struct __attribute__((packed)) {
+    char id[API_AUTH_KEY_ID_MAX];
+    uint8_t scopes;
+    uint8_t flags;
+    uint8_t reserved[2];
+    uint8_t hash[API_AUTH_HASH_LEN];      // SHA-256(키 원문), Bearer 검증에만 사용
+    uint8_t mac_key[API_AUTH_HASH_LEN];   // HMAC-SHA256(키 원문, "mac"), 서명 요청과 UDP MAC에 사용
+} api_key_record_t;
+
+// 이전 NVS 형식 (해시를 HMAC 키로도 쓰던 버전)
+typedef struct __attribute__((packed)) {
+    char id[API_AUTH_KEY_ID_MAX];
+    uint8_t scopes;
+    uint8_t flags;
+    uint8_t reserved[2];
+    uint8_t hash[API_AUTH_HASH_LEN];
+} api_key_legacy_record_t;
+
+static api_key_record_t keys[API_AUTH_KEYS_MAX];
+static size_t key_count = 0;
+// 키별로 마지막으로 받은 서명 요청 nonce (부팅 ID가 바뀌므로 RAM에만 유지)
+static uint64_t last_nonce[API_AUTH_KEYS_MAX];
+static api_auth_stats_t stats[API_AUTH_MODE_COUNT];
+
+static uint32_t boot_id = 0;
+static char challenge[32];
+static SemaphoreHandle_t auth_lock = NULL;
+// 서명 대상 메시지 (auth_lock 안에서만 사용, 호출한 태스크 스택을 쓰지 않도록 정적 할당)
+static char signed_message[SIGNED_MESSAGE_MAX];
+
+// 비교 시간이 일치하는 바이트 수에 따라 달라지지 않도록 전체를 비교
+static bool ct_equal(const uint8_t *a, const uint8_t *b, size_t len)
+{
+    uint8_t diff = 0;
+    for (size_t i = 0; i < len; i++) {
+        diff |= a[i] ^ b[i];
+    }
+    return diff == 0;
+}
+
+static void hash_secret(const char *secret, size_t len, uint8_t hash[API_AUTH_HASH_LEN])
+{
+    mbedtls_sha256((const unsigned char *)secret, len, hash, 0);
+}
+
+// 원문에서 검증 해시와 MAC 키를 따로 유도 (Bearer 검증값으로는 서명을 만들 수 없음)
+static void derive_key(api_key_record_t *record, const char *secret, size_t len)
+{
+    hash_secret(secret, len, record->hash);
+    mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256),
+                    (const unsigned char *)secret, len,
+                    (const unsigned char *)MAC_KEY_LABEL, strlen(MAC_KEY_LABEL), record->mac_key);
+}
+
+void api_auth_compute_mac(const uint8_t key[API_AUTH_HASH_LEN], const void *data, size_t len,
+                          uint8_t *mac, size_t mac_len)
+{
+    uint8_t digest[API_AUTH_HASH_LEN];
+    mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256),
+                    key, API_AUTH_HASH_LEN, (const unsigned char *)data, len, digest);
+    memcpy(mac, digest, mac_len);
+}
+
+static int find_key(const char *id, size_t id_len)
+{
+    for (size_t i = 0; i < key_count; i++) {
+        if (strlen(keys[i].id) == id_len && strncmp(keys[i].id, id, id_len) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+static bool valid_key_id(const char *id)
+{
+    size_t len = strlen(id);
+    if (len == 0 || len >= API_AUTH_KEY_ID_MAX) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        char c = id[i];
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static esp_err_t save_keys(void)
+{
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(API_AUTH_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    err = nvs_set_blob(nvs_handle, API_AUTH_KEYS_NVS_KEY, keys, key_count * sizeof(api_key_record_t));
+    if (err == ESP_OK) {
+        // 새 형식으로 저장했으면 이전 형식 목록은 더 이상 읽지 않음
+        esp_err_t erase_err = nvs_erase_key(nvs_handle, API_AUTH_LEGACY_NVS_KEY);
+        if (erase_err != ESP_OK && erase_err != ESP_ERR_NVS_NOT_FOUND) {
+            err = erase_err;
+        }
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+    return err;
+}
+
+static bool load_keys(void)
+{
+    nvs_handle_t nvs_handle;
+    if (nvs_open(API_AUTH_NAMESPACE, NVS_READONLY, &nvs_handle) != ESP_OK) {
+        return false;
+    }
+
+    size_t size = sizeof(keys);
+    esp_err_t err = nvs_get_blob(nvs_handle, API_AUTH_KEYS_NVS_KEY, keys, &size);
+    if (err == ESP_OK && size > 0 && size % sizeof(api_key_record_t) == 0) {
+        nvs_close(nvs_handle);
+        key_count = size / sizeof(api_key_record_t);
+    } else {
+        // 이전 형식: 원문이 없어 MAC 키를 유도할 수 없으므로 같은 ID로 다시 등록할 때까지 Bearer만 허용
+        api_key_legacy_record_t legacy[API_AUTH_KEYS_MAX];
+        size = sizeof(legacy);
+        err = nvs_get_blob(nvs_handle, API_AUTH_LEGACY_NVS_KEY, legacy, &size);
+        nvs_close(nvs_handle);
+        if (err != ESP_OK || size == 0 || size % sizeof(api_key_legacy_record_t) != 0) {
+            return false;
+        }
+
+        memset(keys, 0, sizeof(keys));
+        key_count = size / sizeof(api_key_legacy_record_t);
+        for (size_t i = 0; i < key_count; i++) {
+            memcpy(keys[i].id, legacy[i].id, API_AUTH_KEY_ID_MAX);
+            keys[i].scopes = legacy[i].scopes;
+            keys[i].flags = legacy[i].flags | API_KEY_FLAG_LEGACY;
+            memcpy(keys[i].hash, legacy[i].hash, API_AUTH_HASH_LEN);
+        }
+        ESP_LOGW(TAG, "이전 형식 API 키 %u개: 다시 등록하기 전까지 서명 요청/UDP 명령에 사용할 수 없음",
+                 (unsigned)key_count);
+    }
+
+    for (size_t i = 0; i < key_count; i++) {
+        keys[i].id[API_AUTH_KEY_ID_MAX - 1] = '\0';
+    }
+    return true;
+}
+
+esp_err_t api_auth_init(void)
+{
+    if (auth_lock == NULL) {
+        auth_lock = xSemaphoreCreateMutex();
+        if (auth_lock == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    do {
+        boot_id = esp_random();
+    } while (boot_id == 0);
+    snprintf(challenge, sizeof(challenge), "HMAC boot=%08" PRIx32, boot_id);
+
+    if (!load_keys()) {
+        // 키를 등록하기 전까지는 컴파일 시 키를 모든 권한으로 사용
+        memset(keys, 0, sizeof(keys));
+        strcpy(keys[0].id, DEFAULT_KEY_ID);
+        keys[0].scopes = API_SCOPE_ALL;
+        derive_key(&keys[0], API_KEY, strlen(API_KEY));
+        key_count = 1;
+    }
+
+    memset(last_nonce, 0, sizeof(last_nonce));
+    memset(stats, 0, sizeof(stats));
+    ESP_LOGI(TAG, "API 키 %u개 로드", (unsigned)key_count);
+    return ESP_OK;
+}
+
+const char *api_auth_challenge(void)
+{
+    return challenge;
+}
+
+uint32_t api_auth_boot_id(void)
+{
+    return boot_id;
+}
+
+// Bearer: 받은 키의 해시를 모든 키와 비교 (어느 키에서 멈췄는지로 정보가 새지 않도록 끝까지 비교)
+static int verify_bearer(const char *token)
+{
+    size_t len = strnlen(token, API_AUTH_SECRET_MAX + 1);
+    if (len < API_AUTH_SECRET_MIN || len > API_AUTH_SECRET_MAX) {
+        return -1;
+    }
+
+    uint8_t hash[API_AUTH_HASH_LEN];
+    hash_secret(token, len, hash);
+
+    int matched = -1;
+    for (size_t i = 0; i < key_count; i++) {
+        if (ct_equal(hash, keys[i].hash, API_AUTH_HASH_LEN)) {
+            matched = (int)i;
+        }
+    }
+
+    if (matched >= 0 && (keys[matched].flags & API_KEY_FLAG_HMAC_ONLY)) {
+        return -1;
+    }
+    return matched;
+}
+
+static bool decode_hex(const char *hex, size_t hex_len, uint8_t *out)
+{
+    for (size_t i = 0; i < hex_len; i++) {
+        char c = hex[i];
+        uint8_t v;
+        if (c >= '0' && c <= '9') {
+            v = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            v = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            v = c - 'A' + 10;
+        } else {
+            return false;
+        }
+        out[i / 2] = (i % 2) ? (out[i / 2] | v) : (uint8_t)(v << 4);
+    }
+    return true;
+}
+
+// 서명: "<키 ID>:<nonce>:<서명 hex>" (auth_lock을 잡은 상태에서 호출)
+static int verify_signed(const char *method, const char *uri, const char *credentials, const api_auth_bound_t *bound)
+{
+    if (bound->content_sha256 == NULL || strlen(bound->content_sha256) != API_AUTH_HASH_LEN * 2) {
+        return -1;
+    }
+
+    const char *nonce_start = strchr(credentials, ':');
+    if (nonce_start == NULL) {
+        return -1;
+    }
+    int slot = find_key(credentials, nonce_start - credentials);
+    if (slot < 0 || (keys[slot].flags & API_KEY_FLAG_LEGACY)) {
+        return -1;
+    }
+
+    char *nonce_end;
+    uint64_t nonce = strtoull(nonce_start + 1, &nonce_end, 10);
+    if (nonce_end == nonce_start + 1 || *nonce_end != ':' || strlen(nonce_end + 1) != API_AUTH_HASH_LEN * 2) {
+        return -1;
+    }
+
+    uint8_t signature[API_AUTH_HASH_LEN];
+    if (!decode_hex(nonce_end + 1, API_AUTH_HASH_LEN * 2, signature)) {
+        return -1;
+    }
+
+    int len = snprintf(signed_message, sizeof(signed_message), "%s\n%s\n%08" PRIx32 "\n%" PRIu64 "\n%s\n%s\n%s",
+                       method, uri, boot_id, nonce, bound->content_sha256,
+                       bound->image_sha256 ? bound->image_sha256 : "",
+                       bound->content_range ? bound->content_range : "");
+    if (len < 0 || len >= (int)sizeof(signed_message)) {
+        return -1;
+    }
+
+    uint8_t expected[API_AUTH_HASH_LEN];
+    api_auth_compute_mac(keys[slot].mac_key, signed_message, len, expected, sizeof(expected));
+    if (!ct_equal(expected, signature, API_AUTH_HASH_LEN) || nonce <= last_nonce[slot]) {
+        return -1;
+    }
+
+    last_nonce[slot] = nonce;
+    return slot;
+}
+
+api_auth_result_t api_auth_verify(const char *method, const char *uri, const char *authorization,
+                                  const api_auth_bound_t *bound, uint8_t scope)
+{
+    if (authorization == NULL) {
+        return API_AUTH_UNAUTHORIZED;
+    }
+
+    api_auth_mode_t mode;
+    if (strncmp(authorization, "Bearer ", 7) == 0) {
+        mode = API_AUTH_MODE_BEARER;
+    } else if (strncmp(authorization, "HMAC ", 5) == 0) {
+        mode = API_AUTH_MODE_HMAC;
+    } else {
+        return API_AUTH_UNAUTHORIZED;
+    }
+
+    // 잠금 대기 시간은 빼고 검증 자체에 걸린 시간만 측정
+    xSemaphoreTake(auth_lock, portMAX_DELAY);
+    int64_t started_us = esp_timer_get_time();
+
+    int slot = mode == API_AUTH_MODE_BEARER
+        ? verify_bearer(authorization + 7)
+        : verify_signed(method, uri, authorization + 5, bound);
+
+    api_auth_result_t result = API_AUTH_UNAUTHORIZED;
+    if (slot >= 0) {
+        result = (keys[slot].scopes & scope) == scope ? API_AUTH_OK : API_AUTH_FORBIDDEN;
+    }
+
+    uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - started_us);
+    api_auth_stats_t *mode_stats = &stats[mode];
+    mode_stats->count++;
+    mode_stats->total_us += elapsed_us;
+    if (elapsed_us > mode_stats->max_us) {
+        mode_stats->max_us = elapsed_us;
+    }
+    if (result != API_AUTH_OK) {
+        mode_stats->failed++;
+    }
+
+    xSemaphoreGive(auth_lock);
+    return result;
+}
+
+bool api_auth_verify_mac(const void *data, size_t len, const uint8_t *mac, size_t mac_len,
+                         uint8_t scope, uint8_t key_out[API_AUTH_HASH_LEN])
+{
+    uint8_t expected[API_AUTH_HASH_LEN];
+    bool matched = false;
+
+    xSemaphoreTake(auth_lock, portMAX_DELAY);
+    // 일치하는 키를 찾은 뒤에도 나머지 키를 모두 계산 (응답 시간으로 몇 번째 키인지 알 수 없도록)
+    for (size_t i = 0; i < key_count; i++) {
+        if ((keys[i].scopes & scope) != scope || (keys[i].flags & API_KEY_FLAG_LEGACY)) {
+            continue;
+        }
+        api_auth_compute_mac(keys[i].mac_key, data, len, expected, mac_len);
+        bool equal = ct_equal(expected, mac, mac_len);
+        if (equal && !matched) {
+            memcpy(key_out, keys[i].mac_key, API_AUTH_HASH_LEN);
+            matched = true;
+        }
+    }
+    xSemaphoreGive(auth_lock);
+
+    return matched;
+}
+
+esp_err_t api_auth_set_key(const char *id, const char *secret, uint8_t scopes, uint8_t flags)
+{
+    size_t secret_len = strlen(secret);
+    if (!valid_key_id(id) || secret_len < API_AUTH_SECRET_MIN || secret_len > API_AUTH_SECRET_MAX ||
+        scopes == 0 || (scopes & ~API_SCOPE_ALL) || (flags & ~API_KEY_FLAG_HMAC_ONLY)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(auth_lock, portMAX_DELAY);
+
+    int slot = find_key(id, strlen(id));
+    if (slot < 0 && key_count >= API_AUTH_KEYS_MAX) {
+        xSemaphoreGive(auth_lock);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // 관리자 키를 교체하면서 관리자 권한이 모두 없어지는 경우 방지
+    bool admin_left = (scopes & API_SCOPE_ADMIN) != 0;
+    for (size_t i = 0; i < key_count; i++) {
+        if ((int)i != slot && (keys[i].scopes & API_SCOPE_ADMIN)) {
+            admin_left = true;
+        }
+    }
+    if (!admin_left) {
+        xSemaphoreGive(auth_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    bool existed = slot >= 0;
+    api_key_record_t previous = {0};
+    if (existed) {
+        previous = keys[slot];
+    } else {
+        slot = (int)key_count++;
+    }
+
+    memset(&keys[slot], 0, sizeof(keys[slot]));
+    strcpy(keys[slot].id, id);
+    keys[slot].scopes = scopes;
+    keys[slot].flags = flags;
+    derive_key(&keys[slot], secret, secret_len);
+    last_nonce[slot] = 0;
+
+    esp_err_t err = save_keys();
+    if (err != ESP_OK) {
+        if (existed) {
+            keys[slot] = previous;
+        } else {
+            key_count--;
+        }
+    }
+
+    xSemaphoreGive(auth_lock);
+
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "API 키 저장: %s (권한 0x%02x)", id, scopes);
+    }
+    return err;
+}
+
+esp_err_t api_auth_delete_key(const char *id)
+{
+    xSemaphoreTake(auth_lock, portMAX_DELAY);
+
+    int slot = find_key(id, strlen(id));
+    if (slot < 0) {
+        xSemaphoreGive(auth_lock);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    bool other_admin = false;
+    for (size_t i = 0; i < key_count; i++) {
+        if ((int)i != slot && (keys[i].scopes & API_SCOPE_ADMIN)) {
+            other_admin = true;
+        }
+    }
+    if (!other_admin) {
+        xSemaphoreGive(auth_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    api_key_record_t removed = keys[slot];
+    uint64_t removed_nonce = last_nonce[slot];
+    for (size_t i = slot; i + 1 < key_count; i++) {
+        keys[i] = keys[i + 1];
+        last_nonce[i] = last_nonce[i + 1];
+    }
+    key_count--;
+
+    esp_err_t err = save_keys();
+    if (err != ESP_OK) {
+        // 저장 실패 시 원래 위치로 복구
+        for (size_t i = key_count; i > (size_t)slot; i--) {
+            keys[i] = keys[i - 1];
+            last_nonce[i] = last_nonce[i - 1];
+        }
+        keys[slot] = removed;
+        last_nonce[slot] = removed_nonce;
+        key_count++;
+    }
+
+    xSemaphoreGive(auth_lock);
+
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "API 키 삭제: %s", id);
+    }
+    return err;
+}
+
+size_t api_auth_list_keys(api_key_info_t *out, size_t max_keys)
+{
+    xSemaphoreTake(auth_lock, portMAX_DELAY);
+    size_t count = key_count < max_keys ? key_count : max_keys;
+    for (size_t i = 0; i < count; i++) {
+        strcpy(out[i].id, keys[i].id);
+        out[i].scopes = keys[i].scopes;
+        out[i].flags = keys[i].flags;
+    }
+    xSemaphoreGive(auth_lock);
+    return count;
+}
+
+void api_auth_get_stats(api_auth_stats_t out[API_AUTH_MODE_COUNT])
+{
+    xSemaphoreTake(auth_lock, portMAX_DELAY);
+    memcpy(out, stats, sizeof(stats));
+    xSemaphoreGive(auth_lock);
+}
@@ -0,0 +1,105 @@
+#ifndef API_AUTH_H
+#define API_AUTH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// API 키 저장소
+// - 키 원문 대신 원문에서 유도한 두 값을 NVS에 저장하고 부팅 시 RAM으로 읽어 요청마다 플래시를 읽지 않음
+//   검증 해시 SHA-256(키): Bearer 비교에만 사용 (유출돼도 원문을 알아야 Bearer 인증 가능)
+//   MAC 키 HMAC-SHA256(키, "mac"): 서명 요청과 UDP MAC에 사용
+//   MAC 키는 대칭 키라 NVS를 읽을 수 있으면 서명 요청/UDP 명령을 만들 수 있음 (플래시 암호화로 보호해야 함)
+// - 저장된 키가 없으면 web_server.h의 API_KEY를 모든 권한의 "default" 키로 사용
+// - 비교는 일치 여부와 관계없이 모든 키의 해시 전체를 비교 (응답 시간으로 키를 추측할 수 없음)
+#define API_AUTH_NAMESPACE   "api_auth"
+#define API_AUTH_KEYS_MAX    8
+#define API_AUTH_KEY_ID_MAX  16     // NUL 포함
+#define API_AUTH_SECRET_MIN  16
+#define API_AUTH_SECRET_MAX  128
+#define API_AUTH_HASH_LEN    32
+
+// 권한 (키마다 조합해서 부여)
+#define API_SCOPE_READ    0x01      // 상태/설정/OTA 진행 조회
+#define API_SCOPE_CONTROL 0x02      // 에어컨 제어 (REST, UDP 명령 채널)
+#define API_SCOPE_ADMIN   0x04      // WiFi/IR 설정, IR 라이브러리, OTA, 키 관리
+#define API_SCOPE_ALL     (API_SCOPE_READ | API_SCOPE_CONTROL | API_SCOPE_ADMIN)
+
+// 키 옵션: Bearer 방식(원문 전송)을 거부하고 서명 요청만 허용
+#define API_KEY_FLAG_HMAC_ONLY 0x01
+// 이전 형식으로 저장된 키 (MAC 키 없음): Bearer만 허용, 같은 ID로 다시 등록하면 해제 (직접 지정 불가)
+#define API_KEY_FLAG_LEGACY    0x80
+
+// 인증 방식
+//   Bearer: Authorization: Bearer <키>
+//   서명:   Authorization: HMAC <키 ID>:<nonce>:<서명 hex>
+//           서명 = HMAC-SHA256(MAC 키, "<메서드>\n<URI>\n<부팅 ID hex>\n<nonce>\n"
+//                                          "<X-Content-SHA256>\n<X-Image-SHA256>\n<Content-Range>")
+//           X-Content-SHA256(본문 SHA-256 hex)은 필수, 나머지 헤더는 없으면 빈 문자열로 서명
+//           본문은 http_body가 받으면서 해시해 X-Content-SHA256과 다르면 반영 전에 거부
+//           nonce는 키마다 이전 요청보다 커야 함 (재전송 방지)
+//           부팅 ID는 부팅마다 바뀌며 401 응답의 WWW-Authenticate: HMAC boot=<hex>로 알려줌
+//           (재부팅 전에 가로챈 요청은 재부팅 후에도 통과하지 못함)
+typedef enum {
+    API_AUTH_MODE_BEARER = 0,
+    API_AUTH_MODE_HMAC,
+    API_AUTH_MODE_COUNT
+} api_auth_mode_t;
+
+typedef enum {
+    API_AUTH_OK = 0,
+    API_AUTH_UNAUTHORIZED,      // 헤더 없음/형식 오류/키 불일치/재사용된 nonce → 401
+    API_AUTH_FORBIDDEN          // 인증은 됐지만 권한 없음 → 403
+} api_auth_result_t;
+
+// 서명에 함께 묶는 요청 헤더 값 (없으면 빈 문자열)
+typedef struct {
+    const char* content_sha256;     // X-Content-SHA256
+    const char* image_sha256;       // X-Image-SHA256 (OTA)
+    const char* content_range;      // Content-Range (OTA 이어받기)
+} api_auth_bound_t;
+
+// 키 정보 (해시 제외, 목록 조회용)
+typedef struct {
+    char id[API_AUTH_KEY_ID_MAX];
+    uint8_t scopes;
+    uint8_t flags;
+} api_key_info_t;
+
+// 방식별 검증 비용 (요청당 마이크로초)
+typedef struct {
+    uint32_t count;
+    uint32_t failed;
+    uint64_t total_us;
+    uint32_t max_us;
+} api_auth_stats_t;
+
+// NVS에서 키 목록을 읽어 RAM에 올림 (NVS 초기화 후 호출)
+esp_err_t api_auth_init(void);
+
+// Authorization 헤더 검증 (method: "GET"/"POST"/..., uri: 쿼리 포함 요청 경로, bound: 서명 방식에서만 사용)
+api_auth_result_t api_auth_verify(const char* method, const char* uri, const char* authorization,
+                                  const api_auth_bound_t* bound, uint8_t scope);
+
+// 401 응답의 WWW-Authenticate 헤더 값 (부팅 동안 유지되는 정적 문자열)
+const char* api_auth_challenge(void);
+
+// UDP 명령 채널: scope 권한이 있는 키 중 mac이 맞는 키를 찾아 그 MAC 키를 key_out에 복사
+bool api_auth_verify_mac(const void* data, size_t len, const uint8_t* mac, size_t mac_len,
+                         uint8_t scope, uint8_t key_out[API_AUTH_HASH_LEN]);
+// HMAC-SHA256(key, data) 앞 mac_len 바이트
+void api_auth_compute_mac(const uint8_t key[API_AUTH_HASH_LEN], const void* data, size_t len,
+                          uint8_t* mac, size_t mac_len);
+
+// 키 추가/교체 (같은 ID면 교체), 원문은 저장하지 않고 검증 해시와 MAC 키만 저장
+esp_err_t api_auth_set_key(const char* id, const char* secret, uint8_t scopes, uint8_t flags);
+// 키 삭제 (마지막 관리자 키는 삭제할 수 없음: ESP_ERR_INVALID_STATE)
+esp_err_t api_auth_delete_key(const char* id);
+
+// 키 목록, 반환값은 키 개수
+size_t api_auth_list_keys(api_key_info_t* keys, size_t max_keys);
+void api_auth_get_stats(api_auth_stats_t stats[API_AUTH_MODE_COUNT]);
+uint32_t api_auth_boot_id(void);
+
+#endif // API_AUTH_H
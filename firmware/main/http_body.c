@@ -0,0 +1,161 @@
+#include "http_body.h"
+#include <string.h>
+#include "esp_log.h"
+#include "mbedtls/sha256.h"
+
+static const char *TAG = "HTTP_BODY";
+
+// 연속 수신 타임아웃 허용 횟수
+#define MAX_RECV_TIMEOUTS 3
+
+// httpd는 단일 태스크에서 핸들러를 순서대로 실행하므로 정적 영역 하나를 공유
+static char body_arena[HTTP_BODY_ARENA_SIZE];
+
+// 서명된 본문 해시 (require_scope가 요청마다 설정)
+static bool expect_hash = false;
+static uint8_t expected_sha256[HTTP_BODY_SHA256_LEN];
+
+void http_body_expect_sha256(const uint8_t* sha256)
+{
+    expect_hash = sha256 != NULL;
+    if (expect_hash) {
+        memcpy(expected_sha256, sha256, HTTP_BODY_SHA256_LEN);
+    }
+}
+
+static void send_error(httpd_req_t *req, const char *status, const char *message)
+{
+    httpd_resp_set_status(req, status);
+    
+    cJSON *response = cJSON_CreateObject();
+    cJSON_AddStringToObject(response, "status", "error");
+    cJSON_AddStringToObject(response, "message", message);
+    
+    char *response_str = cJSON_Print(response);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, response_str, strlen(response_str));
+    
+    free(response_str);
+    cJSON_Delete(response);
+}
+
+// 최대 len 바이트 수신 (타임아웃은 제한 횟수만큼 재시도)
+static int recv_some(httpd_req_t *req, char *buf, size_t len)
+{
+    for (int timeouts = 0; timeouts < MAX_RECV_TIMEOUTS; timeouts++) {
+        int ret = httpd_req_recv(req, buf, len);
+        if (ret != HTTPD_SOCK_ERR_TIMEOUT) {
+            return ret;
+        }
+    }
+    return HTTPD_SOCK_ERR_TIMEOUT;
+}
+
+// 받은 본문 해시 확인 (다르면 400 응답)
+static esp_err_t check_hash(httpd_req_t *req, const uint8_t actual[HTTP_BODY_SHA256_LEN])
+{
+    if (memcmp(actual, expected_sha256, HTTP_BODY_SHA256_LEN) != 0) {
+        ESP_LOGW(TAG, "본문 해시 불일치: %s", req->uri);
+        send_error(req, "400 Bad Request", "본문 해시 불일치");
+        return ESP_ERR_INVALID_CRC;
+    }
+    return ESP_OK;
+}
+
+// recv 결과를 에러 코드로 변환 (타임아웃이면 408 응답)
+static esp_err_t recv_error(httpd_req_t *req, int ret)
+{
+    if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
+        ESP_LOGW(TAG, "본문 수신 타임아웃: %s", req->uri);
+        httpd_resp_send_408(req);
+        return ESP_ERR_TIMEOUT;
+    }
+    ESP_LOGW(TAG, "본문 수신 실패: %s (%d)", req->uri, ret);
+    return ESP_FAIL;
+}
+
+esp_err_t http_body_read_json(httpd_req_t* req, size_t max_len, cJSON** json)
+{
+    *json = NULL;
+    
+    if (req->content_len == 0) {
+        send_error(req, "400 Bad Request", "요청 본문이 없습니다");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (req->content_len > max_len || req->content_len > HTTP_BODY_ARENA_SIZE) {
+        ESP_LOGW(TAG, "본문 크기 초과: %s (%u > %u)", req->uri, (unsigned)req->content_len, (unsigned)max_len);
+        send_error(req, "413 Payload Too Large", "요청 본문이 너무 큽니다");
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    // 여러 TCP 세그먼트로 나뉘어 도착해도 content_len 전체를 받을 때까지 반복
+    size_t received = 0;
+    while (received < req->content_len) {
+        int ret = recv_some(req, body_arena + received, req->content_len - received);
+        if (ret <= 0) {
+            return recv_error(req, ret);
+        }
+        received += ret;
+    }
+    
+    if (expect_hash) {
+        uint8_t actual[HTTP_BODY_SHA256_LEN];
+        mbedtls_sha256((const unsigned char *)body_arena, received, actual, 0);
+        esp_err_t err = check_hash(req, actual);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    
+    *json = cJSON_ParseWithLength(body_arena, received);
+    if (!*json) {
+        send_error(req, "400 Bad Request", "잘못된 JSON 형식입니다");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    return ESP_OK;
+}
+
+esp_err_t http_body_stream(httpd_req_t* req, size_t max_len, http_body_chunk_cb_t cb, void* ctx)
+{
+    if (req->content_len > max_len) {
+        ESP_LOGW(TAG, "본문 크기 초과: %s (%u > %u)", req->uri, (unsigned)req->content_len, (unsigned)max_len);
+        send_error(req, "413 Payload Too Large", "요청 본문이 너무 큽니다");
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    mbedtls_sha256_context sha_ctx;
+    mbedtls_sha256_init(&sha_ctx);
+    mbedtls_sha256_starts(&sha_ctx, 0);
+    
+    esp_err_t err = ESP_OK;
+    size_t remaining = req->content_len;
+    while (remaining > 0) {
+        size_t want = remaining < HTTP_BODY_CHUNK_SIZE ? remaining : HTTP_BODY_CHUNK_SIZE;
+        int ret = recv_some(req, body_arena, want);
+        if (ret <= 0) {
+            err = recv_error(req, ret);
+            break;
+        }
+        
+        mbedtls_sha256_update(&sha_ctx, (const unsigned char *)body_arena, ret);
+        err = cb(body_arena, ret, ctx);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "본문 처리 실패: %s (%s)", req->uri, esp_err_to_name(err));
+            send_error(req, "500 Internal Server Error", "요청 본문 처리 실패");
+            // ESP_FAIL은 소켓 오류 전용이므로 다른 코드로 바꿔 반환
+            err = err == ESP_FAIL ? ESP_ERR_INVALID_STATE : err;
+            break;
+        }
+        remaining -= ret;
+    }
+    
+    if (err == ESP_OK && expect_hash) {
+        uint8_t actual[HTTP_BODY_SHA256_LEN];
+        mbedtls_sha256_finish(&sha_ctx, actual);
+        err = check_hash(req, actual);
+    }
+    mbedtls_sha256_free(&sha_ctx);
+    
+    return err;
+}
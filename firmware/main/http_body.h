@@ -0,0 +1,40 @@
+#ifndef HTTP_BODY_H
+#define HTTP_BODY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+#include "cJSON.h"
+
+// 요청 본문용 고정 스크래치 영역 (httpd 태스크 하나에서만 사용)
+#define HTTP_BODY_ARENA_SIZE 4096
+// 스트리밍 본문 전달 단위
+#define HTTP_BODY_CHUNK_SIZE 1024
+
+// 서명 요청의 본문 SHA-256 (X-Content-SHA256)
+#define HTTP_BODY_SHA256_LEN 32
+
+// 스트리밍 본문 청크 콜백 (ESP_OK 이외를 반환하면 수신 중단)
+typedef esp_err_t (*http_body_chunk_cb_t)(const char* data, size_t len, void* ctx);
+
+// 다음 본문 읽기에서 확인할 SHA-256 설정 (NULL이면 확인 안 함, 인증할 때마다 다시 설정)
+// 본문을 끝까지 받은 뒤 해시가 다르면 400 응답을 보내고 ESP_ERR_INVALID_CRC 반환
+// 스트리밍 본문은 청크를 콜백에 넘긴 뒤 마지막에 확인하므로 호출 측은 그때까지 반영(커밋)하지 않아야 함
+void http_body_expect_sha256(const uint8_t* sha256);
+
+// content_len 만큼 반복 수신해 JSON으로 파싱
+// 실패 시 응답(400/408/413)을 이미 보낸 상태로 에러 반환, 소켓 오류는 ESP_FAIL
+esp_err_t http_body_read_json(httpd_req_t* req, size_t max_len, cJSON** json);
+
+// 본문을 HTTP_BODY_CHUNK_SIZE 단위로 콜백에 전달 (바이너리 업로드용)
+// 실패 시 응답(408/413/500)을 이미 보낸 상태로 에러 반환, 소켓 오류는 ESP_FAIL
+esp_err_t http_body_stream(httpd_req_t* req, size_t max_len, http_body_chunk_cb_t cb, void* ctx);
+
+// 본문 읽기 실패 시 핸들러 반환값 (소켓 오류면 연결 종료)
+static inline esp_err_t http_body_handler_result(esp_err_t err)
+{
+    return err == ESP_FAIL ? ESP_FAIL : ESP_OK;
+}
+
+#endif // HTTP_BODY_H
@@ -0,0 +1,421 @@
+#include "ir_code_library.h"
+#include <string.h>
+#include <stdbool.h>
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "spi_flash_mmap.h"
+#include "esp_rom_crc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "IR_LIBRARY";
+
+// 파티션을 절반씩 A/B 슬롯으로 나눠 사용
+// - 새 라이브러리는 비활성 슬롯에 받고, 검증이 끝나면 데이터 바로 뒤에 커밋 표시를 기록한 뒤 전환
+// - 수신/검증 중에도 기존 라이브러리로 계속 조회하며, 실패하거나 도중에 전원이 끊겨도 기존 라이브러리가 유지됨
+// - 부팅 시 커밋 표시가 있는 유효한 슬롯 중 세대 번호가 큰 쪽을 사용
+#define IR_LIBRARY_SLOT_COUNT   2
+#define IR_LIBRARY_COMMIT_MAGIC 0x4D4C5249  // "IRLM"
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t generation;
+} ir_library_commit_t;
+
+// 커밋 표시 위치 (라이브러리 끝에서 4바이트 정렬)
+#define COMMIT_OFFSET(total_size) (((total_size) + 3) & ~(size_t)3)
+
+// 활성 슬롯을 그대로 메모리 매핑해서 사용 (RAM으로 복사하지 않음)
+static const esp_partition_t *library_partition = NULL;
+static size_t slot_size = 0;
+static esp_partition_mmap_handle_t library_mmap_handle;
+static const uint8_t *library_base = NULL;  // NULL이면 유효한 라이브러리 없음
+static int active_slot = -1;
+static uint32_t active_generation = 0;
+static SemaphoreHandle_t library_mutex = NULL;
+
+// 라이브러리 교체 상태
+static bool update_active = false;
+static int update_slot = 0;
+static size_t update_size = 0;
+static size_t update_written = 0;
+
+#define LIBRARY_HEADER() ((const ir_library_header_t *)library_base)
+#define LIBRARY_MODELS() ((const ir_library_model_t *)(library_base + LIBRARY_HEADER()->models_offset))
+#define LIBRARY_CODES()  ((const ir_library_code_t *)(library_base + LIBRARY_HEADER()->codes_offset))
+
+static const char *library_string(uint32_t offset)
+{
+    return (const char *)(library_base + LIBRARY_HEADER()->strings_offset + offset);
+}
+
+// 슬롯에 담을 수 있는 최대 라이브러리 크기 (커밋 표시 자리 제외)
+static size_t library_capacity(void)
+{
+    return slot_size - sizeof(ir_library_commit_t);
+}
+
+// 헤더, 오프셋 범위, CRC 검증
+static bool library_validate(const uint8_t *base, size_t capacity)
+{
+    const ir_library_header_t *header = (const ir_library_header_t *)base;
+
+    if (header->magic != IR_LIBRARY_MAGIC) {
+        ESP_LOGD(TAG, "라이브러리 헤더 없음");
+        return false;
+    }
+    if (header->version != IR_LIBRARY_VERSION || header->header_size != sizeof(ir_library_header_t)) {
+        ESP_LOGE(TAG, "지원하지 않는 라이브러리 버전: %u", header->version);
+        return false;
+    }
+    if (header->total_size > capacity || header->total_size < sizeof(ir_library_header_t)) {
+        ESP_LOGE(TAG, "라이브러리 크기 오류: %lu", (unsigned long)header->total_size);
+        return false;
+    }
+    if ((uint64_t)header->models_offset + (uint64_t)header->model_count * sizeof(ir_library_model_t) > header->total_size ||
+        (uint64_t)header->codes_offset + (uint64_t)header->code_count * sizeof(ir_library_code_t) > header->total_size ||
+        (uint64_t)header->strings_offset + header->strings_size > header->total_size ||
+        header->strings_size == 0 ||
+        base[header->strings_offset + header->strings_size - 1] != '\0') {
+        ESP_LOGE(TAG, "라이브러리 오프셋 범위 오류");
+        return false;
+    }
+
+    uint32_t crc = esp_rom_crc32_le(0, base + header->header_size, header->total_size - header->header_size);
+    if (crc != header->crc32) {
+        ESP_LOGE(TAG, "라이브러리 CRC 불일치: 0x%08lX != 0x%08lX", (unsigned long)crc, (unsigned long)header->crc32);
+        return false;
+    }
+
+    const ir_library_model_t *models = (const ir_library_model_t *)(base + header->models_offset);
+    for (uint32_t i = 0; i < header->model_count; i++) {
+        if (models[i].brand_offset >= header->strings_size ||
+            models[i].model_offset >= header->strings_size ||
+            (uint64_t)models[i].first_code + models[i].code_count > header->code_count) {
+            ESP_LOGE(TAG, "모델 인덱스 오류: %lu", (unsigned long)i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// 슬롯을 매핑해 검증하고 세대 번호를 읽음, 유효하면 매핑을 유지한 채 true
+static bool slot_open(int slot, const uint8_t **base, esp_partition_mmap_handle_t *handle, uint32_t *generation)
+{
+    const void *ptr = NULL;
+    esp_err_t err = esp_partition_mmap(library_partition, slot * slot_size, slot_size,
+                                       ESP_PARTITION_MMAP_DATA, &ptr, handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "슬롯 %d 매핑 실패: %s", slot, esp_err_to_name(err));
+        return false;
+    }
+
+    const uint8_t *slot_base = ptr;
+    if (library_validate(slot_base, library_capacity())) {
+        const ir_library_header_t *header = (const ir_library_header_t *)slot_base;
+        const ir_library_commit_t *commit =
+            (const ir_library_commit_t *)(slot_base + COMMIT_OFFSET(header->total_size));
+
+        if (commit->magic == IR_LIBRARY_COMMIT_MAGIC) {
+            *generation = commit->generation;
+            *base = slot_base;
+            return true;
+        }
+        // 슬롯 도입 전에 파티션 앞에 기록된 라이브러리는 세대 0으로 취급
+        if (slot == 0) {
+            *generation = 0;
+            *base = slot_base;
+            return true;
+        }
+    }
+
+    esp_partition_munmap(*handle);
+    return false;
+}
+
+// 활성 슬롯 교체 (호출 측에서 mutex 보유)
+static void library_activate(int slot, const uint8_t *base, esp_partition_mmap_handle_t handle, uint32_t generation)
+{
+    if (library_base) {
+        esp_partition_munmap(library_mmap_handle);
+    }
+
+    library_base = base;
+    library_mmap_handle = handle;
+    active_slot = slot;
+    active_generation = generation;
+    ESP_LOGI(TAG, "IR 코드 라이브러리 로드 (슬롯 %d, 세대 %lu): 모델 %lu개, 코드 %lu개",
+             slot, (unsigned long)generation,
+             (unsigned long)LIBRARY_HEADER()->model_count, (unsigned long)LIBRARY_HEADER()->code_count);
+}
+
+// 유효한 슬롯 중 세대 번호가 가장 큰 슬롯을 활성화
+static esp_err_t library_load(void)
+{
+    if (library_base) {
+        esp_partition_munmap(library_mmap_handle);
+        library_base = NULL;
+    }
+
+    for (int slot = 0; slot < IR_LIBRARY_SLOT_COUNT; slot++) {
+        const uint8_t *base;
+        esp_partition_mmap_handle_t handle;
+        uint32_t generation;
+
+        if (!slot_open(slot, &base, &handle, &generation)) {
+            continue;
+        }
+        if (library_base && generation <= active_generation) {
+            esp_partition_munmap(handle);
+            continue;
+        }
+        library_activate(slot, base, handle, generation);
+    }
+
+    if (!library_base) {
+        ESP_LOGW(TAG, "IR 코드 라이브러리 없음");
+        return ESP_ERR_INVALID_STATE;
+    }
+    return ESP_OK;
+}
+
+esp_err_t ir_code_library_init(void)
+{
+    if (!library_mutex) {
+        library_mutex = xSemaphoreCreateMutex();
+        if (!library_mutex) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    library_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                 IR_LIBRARY_PARTITION_SUBTYPE,
+                                                 IR_LIBRARY_PARTITION_LABEL);
+    if (!library_partition) {
+        ESP_LOGW(TAG, "IR 코드 파티션 없음 (기본 코드 사용)");
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    slot_size = (library_partition->size / IR_LIBRARY_SLOT_COUNT) & ~(size_t)(SPI_FLASH_SEC_SIZE - 1);
+    return library_load();
+}
+
+esp_err_t ir_code_library_get_info(ir_library_info_t* info)
+{
+    if (!info) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(info, 0, sizeof(*info));
+    if (!library_partition) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    xSemaphoreTake(library_mutex, portMAX_DELAY);
+    info->partition_size = library_partition->size;
+    info->max_size = library_capacity();
+    if (library_base) {
+        info->model_count = LIBRARY_HEADER()->model_count;
+        info->code_count = LIBRARY_HEADER()->code_count;
+        info->size = LIBRARY_HEADER()->total_size;
+    }
+    xSemaphoreGive(library_mutex);
+
+    return ESP_OK;
+}
+
+// 모델 인덱스 이진 탐색 (호출 측에서 mutex 보유)
+static esp_err_t find_model_locked(const char* brand, const char* model, uint32_t* model_index)
+{
+    if (!library_base) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const ir_library_model_t *models = LIBRARY_MODELS();
+    uint32_t low = 0;
+    uint32_t high = LIBRARY_HEADER()->model_count;
+
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        int cmp = strcmp(library_string(models[mid].brand_offset), brand);
+        if (cmp == 0) {
+            cmp = strcmp(library_string(models[mid].model_offset), model);
+        }
+
+        if (cmp == 0) {
+            *model_index = mid;
+            return ESP_OK;
+        } else if (cmp < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t ir_code_library_find_model(const char* brand, const char* model, uint32_t* model_index)
+{
+    if (!brand || !model || !model_index || !library_mutex) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(library_mutex, portMAX_DELAY);
+    esp_err_t err = find_model_locked(brand, model, model_index);
+    xSemaphoreGive(library_mutex);
+
+    return err;
+}
+
+esp_err_t ir_code_library_lookup(const char* brand, const char* model, uint16_t command, ir_library_code_t* code)
+{
+    if (!brand || !model || !code || !library_mutex) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(library_mutex, portMAX_DELAY);
+
+    uint32_t model_index;
+    esp_err_t err = find_model_locked(brand, model, &model_index);
+    if (err == ESP_OK) {
+        // 모델 범위 안에서 command 이진 탐색
+        const ir_library_model_t *entry = &LIBRARY_MODELS()[model_index];
+        const ir_library_code_t *codes = LIBRARY_CODES() + entry->first_code;
+        uint32_t low = 0;
+        uint32_t high = entry->code_count;
+
+        err = ESP_ERR_NOT_FOUND;
+        while (low < high) {
+            uint32_t mid = low + (high - low) / 2;
+            if (codes[mid].command == command) {
+                memcpy(code, &codes[mid], sizeof(*code));
+                err = ESP_OK;
+                break;
+            } else if (codes[mid].command < command) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+    }
+
+    xSemaphoreGive(library_mutex);
+    return err;
+}
+
+esp_err_t ir_code_library_update_begin(size_t size)
+{
+    if (!library_partition) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (size < sizeof(ir_library_header_t) || size > library_capacity()) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // 활성 슬롯은 건드리지 않으므로 교체 중에도 기존 라이브러리로 조회
+    xSemaphoreTake(library_mutex, portMAX_DELAY);
+    update_slot = library_base ? 1 - active_slot : 0;
+    xSemaphoreGive(library_mutex);
+
+    ESP_LOGI(TAG, "IR 코드 라이브러리 교체 시작 (%u 바이트, 슬롯 %d)", (unsigned)size, update_slot);
+
+    size_t used = COMMIT_OFFSET(size) + sizeof(ir_library_commit_t);
+    size_t erase_size = (used + SPI_FLASH_SEC_SIZE - 1) & ~(SPI_FLASH_SEC_SIZE - 1);
+    esp_err_t err = esp_partition_erase_range(library_partition, update_slot * slot_size, erase_size);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "파티션 지우기 실패: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    update_active = true;
+    update_size = size;
+    update_written = 0;
+    return ESP_OK;
+}
+
+esp_err_t ir_code_library_update_write(const void* data, size_t len)
+{
+    if (!update_active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (update_written + len > update_size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    esp_err_t err = esp_partition_write(library_partition, update_slot * slot_size + update_written, data, len);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "파티션 쓰기 실패: %s", esp_err_to_name(err));
+        update_active = false;
+        return err;
+    }
+
+    update_written += len;
+    return ESP_OK;
+}
+
+void ir_code_library_update_abort(void)
+{
+    if (update_active) {
+        ESP_LOGW(TAG, "IR 코드 라이브러리 교체 취소 (%u/%u 바이트 수신)", (unsigned)update_written, (unsigned)update_size);
+    }
+    update_active = false;
+}
+
+// 수신한 슬롯을 검증하고 커밋 표시를 기록한 뒤 전환 (실패하면 기존 라이브러리 유지)
+esp_err_t ir_code_library_update_end(void)
+{
+    if (!update_active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    update_active = false;
+
+    if (update_written != update_size) {
+        ESP_LOGE(TAG, "라이브러리 수신 불완전: %u/%u", (unsigned)update_written, (unsigned)update_size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    const void *ptr = NULL;
+    esp_partition_mmap_handle_t handle;
+    esp_err_t err = esp_partition_mmap(library_partition, update_slot * slot_size, slot_size,
+                                       ESP_PARTITION_MMAP_DATA, &ptr, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "슬롯 %d 매핑 실패: %s", update_slot, esp_err_to_name(err));
+        return err;
+    }
+    bool valid = library_validate(ptr, library_capacity()) &&
+                 ((const ir_library_header_t *)ptr)->total_size == update_size;
+    esp_partition_munmap(handle);
+
+    if (!valid) {
+        ESP_LOGE(TAG, "라이브러리 검증 실패, 기존 라이브러리 유지");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(library_mutex, portMAX_DELAY);
+    ir_library_commit_t commit = {
+        .magic = IR_LIBRARY_COMMIT_MAGIC,
+        .generation = library_base ? active_generation + 1 : 1,
+    };
+    xSemaphoreGive(library_mutex);
+
+    err = esp_partition_write(library_partition, update_slot * slot_size + COMMIT_OFFSET(update_size),
+                              &commit, sizeof(commit));
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "커밋 표시 기록 실패: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    const uint8_t *base;
+    uint32_t generation;
+    if (!slot_open(update_slot, &base, &handle, &generation)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(library_mutex, portMAX_DELAY);
+    library_activate(update_slot, base, handle, generation);
+    xSemaphoreGive(library_mutex);
+
+    return ESP_OK;
+}
@@ -0,0 +1,78 @@
+#ifndef IR_CODE_LIBRARY_H
+#define IR_CODE_LIBRARY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// IR 코드 라이브러리 파티션 (partitions.csv 참고)
+// 파티션을 절반씩 A/B 슬롯으로 나눠 교체하므로 라이브러리 최대 크기는 파티션의 절반
+#define IR_LIBRARY_PARTITION_LABEL   "ir_codes"
+#define IR_LIBRARY_PARTITION_SUBTYPE 0x40
+
+// 바이너리 포맷 (리틀 엔디언, webserver/tools/pack-ir-library.js 로 생성)
+//   [헤더][모델 인덱스: brand, model 순 정렬][코드: 모델별, command 순 정렬][문자열 테이블]
+#define IR_LIBRARY_MAGIC   0x424C5249  // "IRLB"
+#define IR_LIBRARY_VERSION 1
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t model_count;
+    uint32_t models_offset;
+    uint32_t code_count;
+    uint32_t codes_offset;
+    uint32_t strings_offset;
+    uint32_t strings_size;
+    uint32_t total_size;
+    uint32_t crc32;           // 헤더 이후 전체 데이터의 CRC32
+} ir_library_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t brand_offset;    // 문자열 테이블 내 오프셋 (NUL 종료)
+    uint32_t model_offset;
+    uint32_t first_code;      // 코드 배열 내 시작 인덱스
+    uint16_t code_count;
+    uint16_t reserved;
+} ir_library_model_t;
+
+typedef struct __attribute__((packed)) {
+    uint64_t code;            // MSB부터 전송
+    uint16_t command;         // aircon_command_t
+    uint8_t  bits;            // 1~64
+    uint8_t  repeat;          // 전송 횟수
+    uint16_t header_mark;     // 타이밍 (마이크로초)
+    uint16_t header_space;
+    uint16_t bit_mark;
+    uint16_t one_space;
+    uint16_t zero_space;
+    uint16_t trailer_mark;
+    uint16_t repeat_gap_ms;
+    uint8_t  carrier_khz;     // 예약: 현재 송신부는 캐리어 변조 없이 GPIO로 직접 구동하므로 사용하지 않음
+    uint8_t  reserved[5];
+} ir_library_code_t;
+
+// 라이브러리 정보
+typedef struct {
+    uint32_t model_count;
+    uint32_t code_count;
+    uint32_t size;
+    uint32_t partition_size;
+    uint32_t max_size;        // 업로드 가능한 최대 크기 (슬롯 크기)
+} ir_library_info_t;
+
+// IR 코드 라이브러리 함수들
+esp_err_t ir_code_library_init(void);
+esp_err_t ir_code_library_get_info(ir_library_info_t* info);
+esp_err_t ir_code_library_find_model(const char* brand, const char* model, uint32_t* model_index);
+esp_err_t ir_code_library_lookup(const char* brand, const char* model, uint16_t command, ir_library_code_t* code);
+
+// 라이브러리 교체 (begin → write 반복 → end, 비활성 슬롯에 받아 end에서 검증 후 전환)
+esp_err_t ir_code_library_update_begin(size_t size);
+esp_err_t ir_code_library_update_write(const void* data, size_t len);
+esp_err_t ir_code_library_update_end(void);
+// 받은 데이터를 버리고 교체 취소 (기존 라이브러리 유지)
+void ir_code_library_update_abort(void);
+
+#endif // IR_CODE_LIBRARY_H
@@ -1,8 +1,12 @@
 #include "ir_controller.h"
+#include "ir_code_library.h"
+#include <string.h>
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "nvs.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_timer.h"
 
 static const char *TAG = "IR_CONTROLLER";
@@ -14,6 +18,19 @@ static const char *TAG = "IR_CONTROLLER";
 #define NEC_ONE_SPACE   1690
 #define NEC_ZERO_SPACE  560
 #define NEC_TRAILER     560
+#define NEC_BITS        32
+#define NEC_CARRIER_KHZ 38
+
+// 기본 코드 반복 전송 설정 (신뢰성 향상)
+#define DEFAULT_REPEAT        3
+#define DEFAULT_REPEAT_GAP_MS 100
+// 라이브러리 코드의 허용 반복 횟수 (0이면 아무것도 전송되지 않음)
+#define LIBRARY_REPEAT_MAX    10
+
+// 선택 모델 저장용 NVS
+#define IR_CONFIG_NAMESPACE "ir_config"
+#define IR_BRAND_KEY "brand"
+#define IR_MODEL_KEY "model"
 
 // 에어컨 IR 코드 (예시 - 실제 에어컨에 맞게 수정 필요)
 static const uint32_t aircon_codes[] = {
@@ -29,10 +46,59 @@ static const uint32_t aircon_codes[] = {
     0x20DFC837   // 팬 속도 3
 };
 
+// REST API 명령 이름 (aircon_command_t 순서)
+static const char *const command_names[] = {
+    "power_on",
+    "power_off",
+    "mode_cool",
+    "mode_heat",
+    "mode_fan",
+    "temp_up",
+    "temp_down",
+    "fan_1",
+    "fan_2",
+    "fan_3"
+};
+
+// 코드 라이브러리에서 선택된 모델 (비어 있으면 기본 코드 사용, 읽기/쓰기는 ir_lock 안에서)
+static char selected_brand[IR_MODEL_NAME_MAX];
+static char selected_model[IR_MODEL_NAME_MAX];
+
+// IR LED 점유 잠금 (HTTP 핸들러와 UDP 명령 태스크가 동시에 전송하면 펄스가 섞임)
+// 시퀀스 전체를 잡은 상태에서 개별 명령도 다시 잡으므로 재귀 뮤텍스 사용
+static SemaphoreHandle_t ir_lock = NULL;
+
+static void load_selected_model(void)
+{
+    nvs_handle_t nvs_handle;
+    if (nvs_open(IR_CONFIG_NAMESPACE, NVS_READONLY, &nvs_handle) != ESP_OK) {
+        return;
+    }
+
+    size_t brand_len = sizeof(selected_brand);
+    size_t model_len = sizeof(selected_model);
+    if (nvs_get_str(nvs_handle, IR_BRAND_KEY, selected_brand, &brand_len) != ESP_OK ||
+        nvs_get_str(nvs_handle, IR_MODEL_KEY, selected_model, &model_len) != ESP_OK) {
+        selected_brand[0] = '\0';
+        selected_model[0] = '\0';
+    }
+    nvs_close(nvs_handle);
+
+    if (selected_brand[0]) {
+        ESP_LOGI(TAG, "선택된 모델: %s %s", selected_brand, selected_model);
+    }
+}
+
 esp_err_t ir_controller_init(void)
 {
     ESP_LOGI(TAG, "IR 컨트롤러 초기화");
     
+    ir_lock = xSemaphoreCreateRecursiveMutex();
+    if (!ir_lock) {
+        ESP_LOGE(TAG, "IR 잠금 생성 실패");
+        return ESP_ERR_NO_MEM;
+    }
+    
     // GPIO 설정
     gpio_config_t io_conf = {
         .pin_bit_mask = (1ULL << IR_LED_PIN),
@@ -51,62 +117,175 @@ esp_err_t ir_controller_init(void)
     // IR LED 초기 상태 (OFF)
     gpio_set_level(IR_LED_PIN, 0);
     
+    // 코드 라이브러리 (없으면 기본 코드로 동작)
+    ir_code_library_init();
+    load_selected_model();
+    
     ESP_LOGI(TAG, "IR 컨트롤러 초기화 완료");
     return ESP_OK;
 }
 
-// NEC 프로토콜로 IR 신호 전송
-static void send_nec_code(uint32_t code)
+// 기본 코드를 라이브러리 코드 형식으로 변환 (NEC 프로토콜)
+static void fill_nec_code(uint32_t value, ir_library_code_t* code)
 {
-    ESP_LOGI(TAG, "IR 코드 전송: 0x%08X", code);
+    memset(code, 0, sizeof(*code));
+    code->code = value;
+    code->bits = NEC_BITS;
+    code->repeat = DEFAULT_REPEAT;
+    code->header_mark = NEC_HDR_MARK;
+    code->header_space = NEC_HDR_SPACE;
+    code->bit_mark = NEC_BIT_MARK;
+    code->one_space = NEC_ONE_SPACE;
+    code->zero_space = NEC_ZERO_SPACE;
+    code->trailer_mark = NEC_TRAILER;
+    code->repeat_gap_ms = DEFAULT_REPEAT_GAP_MS;
+    code->carrier_khz = NEC_CARRIER_KHZ;
+}
+
+// 펄스 거리 방식(NEC 계열)으로 IR 신호 전송
+static void send_pulse_code(const ir_library_code_t* code)
+{
+    ESP_LOGI(TAG, "IR 코드 전송: 0x%llX (%d비트)", (unsigned long long)code->code, code->bits);
     
     // 헤더 전송
     gpio_set_level(IR_LED_PIN, 1);
-    esp_timer_delay_us(NEC_HDR_MARK);
+    esp_timer_delay_us(code->header_mark);
     gpio_set_level(IR_LED_PIN, 0);
-    esp_timer_delay_us(NEC_HDR_SPACE);
+    esp_timer_delay_us(code->header_space);
     
-    // 32비트 데이터 전송
-    for (int i = 31; i >= 0; i--) {
+    // 데이터 전송 (MSB 먼저)
+    for (int i = code->bits - 1; i >= 0; i--) {
         gpio_set_level(IR_LED_PIN, 1);
-        esp_timer_delay_us(NEC_BIT_MARK);
+        esp_timer_delay_us(code->bit_mark);
         gpio_set_level(IR_LED_PIN, 0);
         
-        if (code & (1 << i)) {
-            esp_timer_delay_us(NEC_ONE_SPACE);
+        if ((code->code >> i) & 1) {
+            esp_timer_delay_us(code->one_space);
         } else {
-            esp_timer_delay_us(NEC_ZERO_SPACE);
+            esp_timer_delay_us(code->zero_space);
         }
     }
     
     // 트레일러 전송
     gpio_set_level(IR_LED_PIN, 1);
-    esp_timer_delay_us(NEC_TRAILER);
+    esp_timer_delay_us(code->trailer_mark);
     gpio_set_level(IR_LED_PIN, 0);
 }
 
-esp_err_t ir_controller_send_command(aircon_command_t command)
+// 선택된 모델의 라이브러리 코드, 없으면 기본 코드
+// 라이브러리 항목의 비트 수/반복 횟수가 범위를 벗어나면 전송하지 않고 ESP_ERR_INVALID_SIZE
+static esp_err_t resolve_code(aircon_command_t command, ir_library_code_t* code)
 {
     if (command >= sizeof(aircon_codes) / sizeof(aircon_codes[0])) {
-        ESP_LOGE(TAG, "잘못된 명령: %d", command);
         return ESP_ERR_INVALID_ARG;
     }
     
+    // 모델 선택(HTTP 태스크)과 UDP 명령 태스크가 동시에 접근하므로 잠금 안에서 조회
+    xSemaphoreTakeRecursive(ir_lock, portMAX_DELAY);
+    esp_err_t err = selected_brand[0]
+        ? ir_code_library_lookup(selected_brand, selected_model, command, code)
+        : ESP_ERR_NOT_FOUND;
+    xSemaphoreGiveRecursive(ir_lock);
+    
+    if (err != ESP_OK) {
+        fill_nec_code(aircon_codes[command], code);
+        return ESP_OK;
+    }
+    if (code->bits == 0 || code->bits > 64 || code->repeat == 0 || code->repeat > LIBRARY_REPEAT_MAX) {
+        ESP_LOGE(TAG, "잘못된 라이브러리 코드: 명령 %d (%d비트, %d회)", command, code->bits, code->repeat);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return ESP_OK;
+}
+
+esp_err_t ir_controller_send_command(aircon_command_t command)
+{
+    return ir_controller_send_command_traced(command, NULL);
+}
+
+// trace가 있으면 전송 시작/첫 프레임/완료 시각 기록 (이미 기록된 시작 시각은 유지)
+esp_err_t ir_controller_send_command_traced(aircon_command_t command, ir_trace_t* trace)
+{
+    ir_library_code_t code;
+    esp_err_t err = resolve_code(command, &code);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "잘못된 명령: %d", command);
+        return err;
+    }
+    
     ESP_LOGI(TAG, "에어컨 명령 전송: %d", command);
+    xSemaphoreTakeRecursive(ir_lock, portMAX_DELAY);
+    if (trace && !trace->dispatched_us) {
+        trace->dispatched_us = esp_timer_get_time();
+    }
     
-    // IR 코드 전송 (3번 반복하여 신뢰성 향상)
-    for (int i = 0; i < 3; i++) {
-        send_nec_code(aircon_codes[command]);
-        vTaskDelay(pdMS_TO_TICKS(100));  // 100ms 대기
+    // IR 코드 전송 (반복 전송으로 신뢰성 향상)
+    for (int i = 0; i < code.repeat; i++) {
+        send_pulse_code(&code);
+        if (trace && !trace->first_frame_us) {
+            trace->first_frame_us = esp_timer_get_time();
+        }
+        vTaskDelay(pdMS_TO_TICKS(code.repeat_gap_ms));
     }
     
+    if (trace) {
+        trace->completed_us = esp_timer_get_time();
+    }
+    xSemaphoreGiveRecursive(ir_lock);
     return ESP_OK;
 }
 
+// 여러 명령을 한 번에 순서대로 전송 (실패 시 중단, sent에 완료된 명령 수)
+esp_err_t ir_controller_send_sequence(const aircon_command_t* commands, size_t count, uint32_t gap_ms,
+                                      size_t* sent, ir_trace_t* trace)
+{
+    if (!commands || !sent || count > IR_SEQUENCE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    *sent = 0;
+    esp_err_t err = ESP_OK;
+    xSemaphoreTakeRecursive(ir_lock, portMAX_DELAY);
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0 && gap_ms > 0) {
+            vTaskDelay(pdMS_TO_TICKS(gap_ms));
+        }
+        
+        err = ir_controller_send_command_traced(commands[i], trace);
+        if (err != ESP_OK) {
+            break;
+        }
+        (*sent)++;
+    }
+    xSemaphoreGiveRecursive(ir_lock);
+    
+    return err;
+}
+
+esp_err_t ir_controller_parse_command(const char* name, aircon_command_t* command)
+{
+    if (!name || !command) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    for (int i = 0; i < sizeof(command_names) / sizeof(command_names[0]); i++) {
+        if (strcmp(name, command_names[i]) == 0) {
+            *command = (aircon_command_t)i;
+            return ESP_OK;
+        }
+    }
+    
+    return ESP_ERR_NOT_FOUND;
+}
+
 esp_err_t ir_controller_send_raw_code(uint32_t code)
 {
     ESP_LOGI(TAG, "Raw IR 코드 전송: 0x%08X", code);
-    send_nec_code(code);
+    ir_library_code_t nec_code;
+    fill_nec_code(code, &nec_code);
+    xSemaphoreTakeRecursive(ir_lock, portMAX_DELAY);
+    send_pulse_code(&nec_code);
+    xSemaphoreGiveRecursive(ir_lock);
     return ESP_OK;
 }
 
@@ -124,4 +303,64 @@ esp_err_t ir_controller_learn_code(uint32_t* code)
     
     ESP_LOGI(TAG, "학습된 코드: 0x%08X", *code);
     return ESP_OK;
-} 
\ No newline at end of file
+} 
+
+esp_err_t ir_controller_select_model(const char* brand, const char* model)
+{
+    if (!brand || !model || strlen(brand) >= IR_MODEL_NAME_MAX || strlen(model) >= IR_MODEL_NAME_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // 빈 문자열이 아니면 라이브러리에 있는 모델이어야 함
+    if (brand[0]) {
+        uint32_t model_index;
+        esp_err_t err = ir_code_library_find_model(brand, model, &model_index);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "라이브러리에 없는 모델: %s %s", brand, model);
+            return ESP_ERR_NOT_FOUND;
+        }
+    }
+    
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(IR_CONFIG_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "NVS 열기 실패: %s", esp_err_to_name(err));
+        return err;
+    }
+    
+    err = nvs_set_str(nvs_handle, IR_BRAND_KEY, brand);
+    if (err == ESP_OK) {
+        err = nvs_set_str(nvs_handle, IR_MODEL_KEY, model);
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+    
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "모델 설정 저장 실패: %s", esp_err_to_name(err));
+        return err;
+    }
+    
+    xSemaphoreTakeRecursive(ir_lock, portMAX_DELAY);
+    strcpy(selected_brand, brand);
+    strcpy(selected_model, model);
+    xSemaphoreGiveRecursive(ir_lock);
+    ESP_LOGI(TAG, "모델 선택: %s %s", brand[0] ? brand : "(기본)", model);
+    return ESP_OK;
+}
+
+esp_err_t ir_controller_get_model(char* brand, size_t brand_len, char* model, size_t model_len)
+{
+    if (!brand || !model || brand_len == 0 || model_len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    xSemaphoreTakeRecursive(ir_lock, portMAX_DELAY);
+    strncpy(brand, selected_brand, brand_len - 1);
+    brand[brand_len - 1] = '\0';
+    strncpy(model, selected_model, model_len - 1);
+    model[model_len - 1] = '\0';
+    xSemaphoreGiveRecursive(ir_lock);
+    return ESP_OK;
+}
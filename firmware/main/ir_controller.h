@@ -1,11 +1,19 @@
 #ifndef IR_CONTROLLER_H
 #define IR_CONTROLLER_H
 
+#include <stddef.h>
+#include <stdint.h>
 #include "esp_err.h"
 
 // IR LED 핀 정의
 #define IR_LED_PIN 2
 
+// 선택 모델 이름 최대 길이
+#define IR_MODEL_NAME_MAX 32
+
+// 한 번에 전송할 수 있는 명령 시퀀스 최대 길이
+#define IR_SEQUENCE_MAX 32
+
 // 에어컨 제어 명령
 typedef enum {
     AIRCON_POWER_ON = 0,
@@ -17,13 +25,30 @@ typedef enum {
     AIRCON_TEMP_DOWN,
     AIRCON_FAN_SPEED_1,
     AIRCON_FAN_SPEED_2,
-    AIRCON_FAN_SPEED_3
+    AIRCON_FAN_SPEED_3,
+    AIRCON_COMMAND_COUNT      // 명령 개수 (UDP 명령 번호 검증용)
 } aircon_command_t;
 
+// 명령 처리 구간 타임스탬프 (esp_timer_get_time 기준 마이크로초, 0이면 미기록)
+typedef struct {
+    int64_t received_us;      // 핸들러 진입
+    int64_t dispatched_us;    // 본문 파싱/검증 후 IR 전송 시작
+    int64_t first_frame_us;   // 첫 IR 프레임 송신 완료
+    int64_t completed_us;     // 반복 전송 포함 전체 완료
+} ir_trace_t;
+
 // IR 컨트롤러 함수들
 esp_err_t ir_controller_init(void);
 esp_err_t ir_controller_send_command(aircon_command_t command);
+esp_err_t ir_controller_send_command_traced(aircon_command_t command, ir_trace_t* trace);
+esp_err_t ir_controller_send_sequence(const aircon_command_t* commands, size_t count, uint32_t gap_ms,
+                                      size_t* sent, ir_trace_t* trace);
+esp_err_t ir_controller_parse_command(const char* name, aircon_command_t* command);
 esp_err_t ir_controller_send_raw_code(uint32_t code);
 esp_err_t ir_controller_learn_code(uint32_t* code);
 
+// 코드 라이브러리 모델 선택 (빈 문자열이면 기본 코드 사용)
+esp_err_t ir_controller_select_model(const char* brand, const char* model);
+esp_err_t ir_controller_get_model(char* brand, size_t brand_len, char* model, size_t model_len);
+
 #endif // IR_CONTROLLER_H 
\ No newline at end of file
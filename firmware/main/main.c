@@ -13,6 +13,9 @@
 #include "wifi_manager.h"
 #include "web_server.h"
 #include "ir_controller.h"
+#include "ota_updater.h"
+#include "udp_command.h"
+#include "api_auth.h"
 
 static const char *TAG = "MAIN";
 
@@ -20,6 +23,9 @@ static const char *TAG = "MAIN";
 static EventGroupHandle_t wifi_event_group;
 const int WIFI_CONNECTED_BIT = BIT0;
 
+// OTA로 받은 새 펌웨어의 WiFi 연결 대기 시간 (넘으면 이전 펌웨어로 롤백)
+#define OTA_VERIFY_WIFI_TIMEOUT_MS (120 * 1000)
+
 // WiFi 이벤트 핸들러
 static void event_handler(void* arg, esp_event_base_t event_base,
                           int32_t event_id, void* event_data)
@@ -37,8 +43,8 @@ static void event_handler(void* arg, esp_event_base_t event_base,
     }
 }
 
-// WiFi 초기화
-static void wifi_init_sta(void)
+// WiFi 초기화, timeout 안에 연결되면 true
+static bool wifi_init_sta(TickType_t timeout)
 {
     wifi_event_group = xEventGroupCreate();
 
@@ -83,13 +89,14 @@ static void wifi_init_sta(void)
             WIFI_CONNECTED_BIT,
             pdFALSE,
             pdFALSE,
-            portMAX_DELAY);
+            timeout);
 
     if (bits & WIFI_CONNECTED_BIT) {
         ESP_LOGI(TAG, "WiFi 연결 성공");
-    } else {
-        ESP_LOGE(TAG, "WiFi 연결 실패");
+        return true;
     }
+    ESP_LOGE(TAG, "WiFi 연결 실패 (시간 초과)");
+    return false;
 }
 
 void app_main(void)
@@ -104,14 +111,29 @@ void app_main(void)
     }
     ESP_ERROR_CHECK(ret);
 
+    // API 키 저장소 (웹 서버와 UDP 명령 채널이 요청마다 RAM에서 검증)
+    ESP_ERROR_CHECK(api_auth_init());
+
     // IR 컨트롤러 초기화
     ir_controller_init();
     
     // WiFi 연결
-    wifi_init_sta();
+    // 확인 대기 중인 새 펌웨어는 제한 시간만 기다림 (연결하지 못하는 이미지가 확정도 롤백도 안 된 채 남지 않도록)
+    ota_status_t ota_status;
+    bool pending_verify = ota_updater_get_status(&ota_status) == ESP_OK && ota_status.pending_verify;
+    bool wifi_connected = wifi_init_sta(pending_verify ? pdMS_TO_TICKS(OTA_VERIFY_WIFI_TIMEOUT_MS) : portMAX_DELAY);
     
     // 웹 서버 시작
-    web_server_start();
+    esp_err_t web_err = wifi_connected ? web_server_start() : ESP_ERR_TIMEOUT;
+    
+#if UDP_COMMAND_ENABLED
+    // UDP 명령 채널 (실패해도 REST API로 제어 가능하므로 부팅 확정에는 반영하지 않음)
+    udp_command_start(UDP_COMMAND_PORT);
+#endif
+    
+    // OTA로 새 펌웨어가 부팅된 경우: WiFi 연결과 웹 서버 시작까지 정상이면 확정,
+    // 아니면(WiFi 시간 초과 포함) esp_ota_mark_app_invalid_rollback_and_reboot로 롤백
+    ota_updater_confirm_boot(wifi_connected && web_err == ESP_OK);
     
     ESP_LOGI(TAG, "시스템 초기화 완료");
     
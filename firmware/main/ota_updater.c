@@ -0,0 +1,192 @@
+#include "ota_updater.h"
+#include <string.h>
+#include "esp_log.h"
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "mbedtls/sha256.h"
+
+static const char *TAG = "OTA_UPDATER";
+
+// 진행 중인 OTA 세션 (httpd 태스크에서만 접근)
+// 연결이 끊겨도 세션을 유지해 같은 이미지는 received 오프셋부터 이어받는다.
+static struct {
+    bool active;
+    esp_ota_handle_t handle;
+    const esp_partition_t *partition;
+    size_t image_size;
+    size_t received;
+    uint8_t expected_sha256[OTA_SHA256_LEN];
+    mbedtls_sha256_context sha_ctx;
+} session;
+
+static void session_reset(void)
+{
+    if (session.active) {
+        esp_ota_abort(session.handle);
+        mbedtls_sha256_free(&session.sha_ctx);
+    }
+    memset(&session, 0, sizeof(session));
+}
+
+esp_err_t ota_updater_begin(size_t image_size, const uint8_t sha256[OTA_SHA256_LEN], size_t* resume_offset)
+{
+    if (!sha256 || !resume_offset || image_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // 같은 이미지의 세션이 남아 있으면 이어받기
+    if (session.active && session.image_size == image_size &&
+        memcmp(session.expected_sha256, sha256, OTA_SHA256_LEN) == 0) {
+        *resume_offset = session.received;
+        ESP_LOGI(TAG, "OTA 재개: %u/%u", (unsigned)session.received, (unsigned)image_size);
+        return ESP_OK;
+    }
+
+    session_reset();
+
+    const esp_partition_t *partition = esp_ota_get_next_update_partition(NULL);
+    if (!partition) {
+        ESP_LOGE(TAG, "OTA 파티션 없음");
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (image_size > partition->size) {
+        ESP_LOGE(TAG, "이미지가 파티션보다 큼: %u > %lu", (unsigned)image_size, (unsigned long)partition->size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // 순차 쓰기 모드: 전체를 미리 지우지 않고 쓰는 섹터만 지움
+    esp_err_t err = esp_ota_begin(partition, OTA_WITH_SEQUENTIAL_WRITES, &session.handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "OTA 시작 실패: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    session.active = true;
+    session.partition = partition;
+    session.image_size = image_size;
+    session.received = 0;
+    memcpy(session.expected_sha256, sha256, OTA_SHA256_LEN);
+    mbedtls_sha256_init(&session.sha_ctx);
+    mbedtls_sha256_starts(&session.sha_ctx, 0);
+
+    *resume_offset = 0;
+    ESP_LOGI(TAG, "OTA 시작: %s 파티션, %u 바이트", partition->label, (unsigned)image_size);
+    return ESP_OK;
+}
+
+esp_err_t ota_updater_write(size_t offset, const void* data, size_t len)
+{
+    if (!session.active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (offset != session.received) {
+        ESP_LOGW(TAG, "OTA 오프셋 불일치: %u != %u", (unsigned)offset, (unsigned)session.received);
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (session.received + len > session.image_size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    esp_err_t err = esp_ota_write(session.handle, data, len);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "OTA 쓰기 실패: %s", esp_err_to_name(err));
+        session_reset();
+        return err;
+    }
+
+    mbedtls_sha256_update(&session.sha_ctx, data, len);
+    session.received += len;
+    return ESP_OK;
+}
+
+esp_err_t ota_updater_finish(void)
+{
+    if (!session.active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (session.received != session.image_size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    uint8_t digest[OTA_SHA256_LEN];
+    mbedtls_sha256_finish(&session.sha_ctx, digest);
+    if (memcmp(digest, session.expected_sha256, OTA_SHA256_LEN) != 0) {
+        ESP_LOGE(TAG, "OTA 이미지 SHA-256 불일치");
+        session_reset();
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    // esp_ota_end는 이미지 헤더/체크섬을 검증하고 핸들을 해제
+    esp_err_t err = esp_ota_end(session.handle);
+    mbedtls_sha256_free(&session.sha_ctx);
+    const esp_partition_t *partition = session.partition;
+    memset(&session, 0, sizeof(session));
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "OTA 이미지 검증 실패: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    err = esp_ota_set_boot_partition(partition);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "부트 파티션 설정 실패: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    ESP_LOGI(TAG, "OTA 완료, 다음 부팅 파티션: %s", partition->label);
+    return ESP_OK;
+}
+
+void ota_updater_abort(void)
+{
+    if (session.active) {
+        ESP_LOGI(TAG, "OTA 세션 취소");
+    }
+    session_reset();
+}
+
+esp_err_t ota_updater_get_status(ota_status_t* status)
+{
+    if (!status) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(status, 0, sizeof(*status));
+
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    status->running_partition = running ? running->label : "";
+
+    esp_ota_img_states_t state;
+    if (running && esp_ota_get_state_partition(running, &state) == ESP_OK) {
+        status->pending_verify = (state == ESP_OTA_IMG_PENDING_VERIFY);
+    }
+
+    const esp_partition_t *target = session.active ? session.partition : esp_ota_get_next_update_partition(NULL);
+    status->target_partition = target ? target->label : "";
+
+    status->active = session.active;
+    status->image_size = session.image_size;
+    status->received = session.received;
+    memcpy(status->sha256, session.expected_sha256, OTA_SHA256_LEN);
+
+    return ESP_OK;
+}
+
+esp_err_t ota_updater_confirm_boot(bool healthy)
+{
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    esp_ota_img_states_t state;
+
+    if (!running || esp_ota_get_state_partition(running, &state) != ESP_OK ||
+        state != ESP_OTA_IMG_PENDING_VERIFY) {
+        return ESP_OK;
+    }
+
+    if (healthy) {
+        ESP_LOGI(TAG, "새 펌웨어 정상 동작 확인 (%s)", running->label);
+        return esp_ota_mark_app_valid_cancel_rollback();
+    }
+
+    ESP_LOGE(TAG, "새 펌웨어 동작 이상, 이전 펌웨어로 롤백");
+    return esp_ota_mark_app_invalid_rollback_and_reboot();
+}
@@ -0,0 +1,32 @@
+#ifndef OTA_UPDATER_H
+#define OTA_UPDATER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define OTA_SHA256_LEN 32
+
+// OTA 진행 상태
+typedef struct {
+    bool active;                    // 수신 중인 세션 존재 여부
+    size_t image_size;
+    size_t received;                // 다음에 받아야 할 오프셋 (재개 위치)
+    uint8_t sha256[OTA_SHA256_LEN]; // 세션의 기대 해시
+    const char* running_partition;
+    const char* target_partition;
+    bool pending_verify;            // 새 이미지로 부팅 후 아직 확정되지 않음
+} ota_status_t;
+
+// OTA 업데이트 함수들
+esp_err_t ota_updater_begin(size_t image_size, const uint8_t sha256[OTA_SHA256_LEN], size_t* resume_offset);
+esp_err_t ota_updater_write(size_t offset, const void* data, size_t len);
+esp_err_t ota_updater_finish(void);
+void ota_updater_abort(void);
+esp_err_t ota_updater_get_status(ota_status_t* status);
+
+// 부팅 확인 (정상 동작 확인 후 롤백 취소, 실패 시 이전 이미지로 롤백)
+esp_err_t ota_updater_confirm_boot(bool healthy);
+
+#endif // OTA_UPDATER_H
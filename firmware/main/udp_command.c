@@ -0,0 +1,270 @@
+#include "udp_command.h"
+#include "ir_controller.h"
+#include "api_auth.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+
+static const char *TAG = "UDP_COMMAND";
+
+#define UDP_TASK_STACK    4096
+#define UDP_TASK_PRIORITY 5
+
+// 기억하는 클라이언트 세션 수와 세션별 응답 캐시 크기
+// (클라이언트는 응답을 받아야 다음 재전송을 멈추므로 최근 몇 개만 있으면 충분)
+#define UDP_SESSION_MAX   4
+#define UDP_ACK_CACHE     4
+// 이 시간 안에 패킷을 받은 세션은 새 세션 발급으로 밀어내지 않음
+#define UDP_SESSION_IDLE_US (60LL * 1000 * 1000)
+
+#define UDP_GAP_MAX_10MS  100
+
+// 서버(udpClient.js)와 맞춘 고정 패킷 크기
+_Static_assert(sizeof(udp_command_packet_t) == 48, "명령 패킷 크기 불일치");
+_Static_assert(sizeof(udp_ack_packet_t) == 64, "응답 패킷 크기 불일치");
+
+typedef struct {
+    bool active;
+    uint32_t session;
+    uint32_t source_addr;     // 세션을 발급받은 주소/포트 (네트워크 바이트 순서)
+    uint16_t source_port;
+    uint32_t last_sequence;
+    int64_t last_seen_us;
+    udp_ack_packet_t acks[UDP_ACK_CACHE];
+    uint8_t next_ack;
+} udp_session_t;
+
+static udp_session_t sessions[UDP_SESSION_MAX];
+static int udp_socket = -1;
+
+// 발급한 세션 조회 (없으면 NULL)
+static udp_session_t *find_session(uint32_t session)
+{
+    for (int i = 0; i < UDP_SESSION_MAX; i++) {
+        if (sessions[i].active && sessions[i].session == session) {
+            return &sessions[i];
+        }
+    }
+    return NULL;
+}
+
+// 세션 발급: 같은 주소에 발급하고 아직 쓰지 않은 세션이 있으면 그대로 다시 알려주고,
+// 없으면 비어 있거나 UDP_SESSION_IDLE_US 넘게 조용했던 슬롯 중 가장 오래된 것을 재사용
+// 가로챈 패킷을 반복해 보내도 한 주소당 세션 하나만 차지하고 사용 중인 세션은 밀어내지 못함
+// 모든 슬롯이 사용 중이면 NULL
+// ID는 부팅마다 다른 난수라 이전 부팅이나 정리된 세션의 ID와 겹치지 않음 (0은 미발급 표시)
+static udp_session_t *issue_session(const struct sockaddr_in *source, int64_t now_us)
+{
+    udp_session_t *oldest = NULL;
+    for (int i = 0; i < UDP_SESSION_MAX; i++) {
+        udp_session_t *slot = &sessions[i];
+        if (slot->active && slot->last_sequence == 0 &&
+            slot->source_addr == source->sin_addr.s_addr && slot->source_port == source->sin_port) {
+            return slot;
+        }
+        if (slot->active && now_us - slot->last_seen_us < UDP_SESSION_IDLE_US) {
+            continue;
+        }
+        if (!oldest || (oldest->active && (!slot->active || slot->last_seen_us < oldest->last_seen_us))) {
+            oldest = slot;
+        }
+    }
+    if (!oldest) {
+        return NULL;
+    }
+
+    uint32_t id;
+    do {
+        id = esp_random();
+    } while (id == 0 || find_session(id));
+
+    memset(oldest, 0, sizeof(*oldest));
+    oldest->active = true;
+    oldest->session = id;
+    oldest->source_addr = source->sin_addr.s_addr;
+    oldest->source_port = source->sin_port;
+    oldest->last_seen_us = now_us;
+    return oldest;
+}
+
+static const udp_ack_packet_t *find_cached_ack(const udp_session_t *session, uint32_t sequence)
+{
+    for (int i = 0; i < UDP_ACK_CACHE; i++) {
+        if (session->acks[i].magic == UDP_ACK_MAGIC && session->acks[i].sequence == sequence) {
+            return &session->acks[i];
+        }
+    }
+    return NULL;
+}
+
+static void init_ack(const udp_command_packet_t *packet, udp_ack_packet_t *ack, udp_command_status_t status)
+{
+    memset(ack, 0, sizeof(*ack));
+    ack->magic = UDP_ACK_MAGIC;
+    ack->version = UDP_COMMAND_VERSION;
+    ack->status = status;
+    ack->session = packet->session;
+    ack->sequence = packet->sequence;
+}
+
+// 요청을 인증한 키로 응답 서명
+static void seal_ack(udp_ack_packet_t *ack, const uint8_t key[API_AUTH_HASH_LEN])
+{
+    api_auth_compute_mac(key, ack, offsetof(udp_ack_packet_t, mac), ack->mac, UDP_COMMAND_MAC_LEN);
+}
+
+// 단계를 명령 배열로 펼쳐 전송 (REST /api/aircon/sequence와 같은 규칙)
+static void execute_packet(const udp_command_packet_t *packet, int64_t received_us, udp_ack_packet_t *ack)
+{
+    aircon_command_t commands[IR_SEQUENCE_MAX];
+    size_t count = 0;
+    bool valid = packet->step_count >= 1 && packet->step_count <= UDP_COMMAND_STEPS_MAX &&
+                 packet->gap_10ms <= UDP_GAP_MAX_10MS;
+
+    for (int i = 0; valid && i < packet->step_count; i++) {
+        uint8_t command = packet->steps[i].command;
+        uint8_t times = packet->steps[i].count;
+        if (command >= AIRCON_COMMAND_COUNT || times < 1 || count + times > IR_SEQUENCE_MAX) {
+            valid = false;
+            break;
+        }
+        for (int j = 0; j < times; j++) {
+            commands[count++] = (aircon_command_t)command;
+        }
+    }
+
+    if (!valid) {
+        init_ack(packet, ack, UDP_STATUS_BAD_REQUEST);
+        ack->received_us = received_us;
+        return;
+    }
+
+    ir_trace_t trace = { .received_us = received_us };
+    size_t sent = 0;
+    esp_err_t err = ir_controller_send_sequence(commands, count, packet->gap_10ms * 10, &sent, &trace);
+
+    init_ack(packet, ack, err == ESP_OK ? UDP_STATUS_OK : UDP_STATUS_IR_FAILED);
+    ack->executed = sent;
+    ack->total = count;
+    ack->received_us = trace.received_us;
+    ack->dispatched_us = trace.dispatched_us;
+    ack->first_frame_us = trace.first_frame_us;
+    ack->completed_us = trace.completed_us;
+}
+
+static void send_ack(const udp_ack_packet_t *ack, const struct sockaddr_in *to)
+{
+    if (sendto(udp_socket, ack, sizeof(*ack), 0, (const struct sockaddr *)to, sizeof(*to)) < 0) {
+        ESP_LOGW(TAG, "응답 전송 실패: errno %d", errno);
+    }
+}
+
+static void udp_command_task(void *arg)
+{
+    udp_command_packet_t packet;
+    struct sockaddr_in source;
+    uint8_t key[API_AUTH_HASH_LEN];
+
+    while (1) {
+        socklen_t source_len = sizeof(source);
+        int received = recvfrom(udp_socket, &packet, sizeof(packet), 0,
+                                (struct sockaddr *)&source, &source_len);
+        int64_t received_us = esp_timer_get_time();
+
+        if (received < 0) {
+            ESP_LOGE(TAG, "수신 실패: errno %d", errno);
+            vTaskDelay(pdMS_TO_TICKS(100));
+            continue;
+        }
+
+        // 형식이 맞지 않거나 인증에 실패한 패킷은 응답 없이 버림
+        if (received != sizeof(packet) || packet.magic != UDP_COMMAND_MAGIC ||
+            packet.version != UDP_COMMAND_VERSION) {
+            continue;
+        }
+        if (!api_auth_verify_mac(&packet, offsetof(udp_command_packet_t, mac), packet.mac,
+                                 UDP_COMMAND_MAC_LEN, API_SCOPE_CONTROL, key)) {
+            ESP_LOGW(TAG, "인증 실패 패킷 무시");
+            continue;
+        }
+
+        // 모르는 세션: 실행하지 않고 새 세션을 발급 (재부팅/세션 정리 후 가로챈 패킷의 재전송 방지)
+        // 다시 알려주는 미사용 세션의 last_seen_us는 갱신하지 않아 재전송만으로 슬롯을 붙잡아 둘 수 없음
+        udp_session_t *session = find_session(packet.session);
+        if (!session) {
+            session = issue_session(&source, received_us);
+
+            udp_ack_packet_t issued;
+            if (session) {
+                init_ack(&packet, &issued, UDP_STATUS_SESSION);
+                issued.session = session->session;
+            } else {
+                ESP_LOGW(TAG, "사용 중인 세션이 가득 차 발급 거부");
+                init_ack(&packet, &issued, UDP_STATUS_BUSY);
+            }
+            seal_ack(&issued, key);
+            send_ack(&issued, &source);
+            continue;
+        }
+        session->last_seen_us = received_us;
+
+        // 재전송된 요청: IR을 다시 보내지 않고 이전 응답을 그대로 전송
+        if (packet.sequence <= session->last_sequence) {
+            const udp_ack_packet_t *cached = find_cached_ack(session, packet.sequence);
+            if (cached) {
+                send_ack(cached, &source);
+            } else {
+                udp_ack_packet_t stale;
+                init_ack(&packet, &stale, UDP_STATUS_STALE);
+                seal_ack(&stale, key);
+                send_ack(&stale, &source);
+            }
+            continue;
+        }
+
+        udp_ack_packet_t *ack = &session->acks[session->next_ack];
+        session->next_ack = (session->next_ack + 1) % UDP_ACK_CACHE;
+        session->last_sequence = packet.sequence;
+
+        execute_packet(&packet, received_us, ack);
+        seal_ack(ack, key);
+        send_ack(ack, &source);
+    }
+}
+
+esp_err_t udp_command_start(uint16_t port)
+{
+    udp_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (udp_socket < 0) {
+        ESP_LOGE(TAG, "소켓 생성 실패: errno %d", errno);
+        return ESP_FAIL;
+    }
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(udp_socket, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        ESP_LOGE(TAG, "포트 %d 바인드 실패: errno %d", port, errno);
+        closesocket(udp_socket);
+        udp_socket = -1;
+        return ESP_FAIL;
+    }
+
+    if (xTaskCreate(udp_command_task, "udp_command", UDP_TASK_STACK, NULL, UDP_TASK_PRIORITY, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "태스크 생성 실패");
+        closesocket(udp_socket);
+        udp_socket = -1;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "UDP 명령 채널 시작: 포트 %d", port);
+    return ESP_OK;
+}
@@ -0,0 +1,73 @@
+#ifndef UDP_COMMAND_H
+#define UDP_COMMAND_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// UDP 명령 채널 사용 여부 (0이면 REST API만 사용)
+#ifndef UDP_COMMAND_ENABLED
+#define UDP_COMMAND_ENABLED 1
+#endif
+
+#define UDP_COMMAND_PORT      4210
+#define UDP_COMMAND_VERSION   2
+#define UDP_COMMAND_STEPS_MAX 8
+#define UDP_COMMAND_MAC_LEN   16
+
+// 패킷 식별자 (리틀 엔디언 "ACU1", "ACK1")
+#define UDP_COMMAND_MAGIC 0x31554341
+#define UDP_ACK_MAGIC     0x314B4341
+
+// 응답 상태
+typedef enum {
+    UDP_STATUS_OK = 0,
+    UDP_STATUS_IR_FAILED,     // 전송 중 실패 (executed까지만 전송됨)
+    UDP_STATUS_BAD_REQUEST,   // 잘못된 명령 번호/반복 횟수/간격
+    UDP_STATUS_STALE,         // 이미 지난 시퀀스 번호이고 캐시된 응답도 없음 (재전송 불필요)
+    UDP_STATUS_SESSION,       // 모르는 세션: 실행하지 않고 응답의 session에 새 세션 ID를 보냄 (그 세션으로 다시 전송)
+    UDP_STATUS_BUSY           // 모르는 세션인데 모든 세션이 최근까지 사용 중이라 발급하지 못함 (실행하지 않음)
+} udp_command_status_t;
+
+// 명령 패킷 (48바이트, 모든 필드 리틀 엔디언)
+// - session: 디바이스가 발급한 세션 ID (처음에는 0으로 보내 UDP_STATUS_SESSION 응답으로 발급받음)
+//   디바이스가 모르는 세션(재부팅, 오래된 세션 정리)의 패킷은 실행하지 않으므로
+//   가로챈 패킷을 재부팅 후나 세션이 정리된 뒤에 다시 보내도 IR이 나가지 않음
+//   발급은 주소/포트당 미사용 세션 하나로 제한되고, 최근 60초 안에 쓰인 세션은 새 발급으로 밀려나지 않음
+// - sequence: 세션 안에서 증가, 같은 (session, sequence)를 다시 받으면 IR을 재전송하지 않고 캐시된 응답을 보냄
+// - mac: HMAC-SHA256(MAC 키, mac 앞까지의 바이트) 앞 16바이트 (MAC 키 = HMAC-SHA256(API 키, "mac"), api_auth.h)
+//        제어 권한(API_SCOPE_CONTROL)이 있는 키 중 하나로 서명, 응답은 같은 키로 서명
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t step_count;       // 사용하는 steps 개수 (1..UDP_COMMAND_STEPS_MAX)
+    uint8_t gap_10ms;         // 명령 사이 간격 (10ms 단위, 최대 100)
+    uint8_t reserved;
+    uint32_t session;
+    uint32_t sequence;
+    struct __attribute__((packed)) {
+        uint8_t command;      // aircon_command_t
+        uint8_t count;        // 반복 횟수 (1 이상)
+    } steps[UDP_COMMAND_STEPS_MAX];
+    uint8_t mac[UDP_COMMAND_MAC_LEN];
+} udp_command_packet_t;
+
+// 응답 패킷 (64바이트), 타임스탬프는 ir_trace_t와 같음
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t status;           // udp_command_status_t
+    uint8_t executed;         // 실제 전송된 명령 수
+    uint8_t total;            // 요청된 명령 수 (반복 포함)
+    uint32_t session;
+    uint32_t sequence;
+    int64_t received_us;
+    int64_t dispatched_us;
+    int64_t first_frame_us;
+    int64_t completed_us;
+    uint8_t mac[UDP_COMMAND_MAC_LEN];
+} udp_ack_packet_t;
+
+// UDP 명령 수신 태스크 시작 (WiFi 연결 후 호출)
+esp_err_t udp_command_start(uint16_t port);
+
+#endif // UDP_COMMAND_H
@@ -3,38 +3,144 @@
 #include "esp_log.h"
 #include "cJSON.h"
 #include "ir_controller.h"
+#include "ir_code_library.h"
+#include "ota_updater.h"
+#include "http_body.h"
+#include "api_auth.h"
 #include "wifi_manager.h"
+#include "esp_app_desc.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include <inttypes.h>
 
 static const char *TAG = "WEB_SERVER";
 
 static httpd_handle_t server = NULL;
 
-// API 키 (실제 운영에서는 더 복잡한 인증 시스템 사용)
-#define API_KEY "aircon_control_2024"
+// 엔드포인트별 요청 본문 최대 크기
+#define BODY_LIMIT_COMMAND   256
+#define BODY_LIMIT_CONFIG    512
+#define BODY_LIMIT_SEQUENCE  1024
+#define BODY_LIMIT_OTA       (0x180000)
+
+// Authorization 헤더 최대 길이 (Bearer 키 또는 서명)
+#define AUTH_HEADER_MAX 160
+// 서명에 묶이는 Content-Range 헤더 최대 길이
+#define BOUND_HEADER_MAX 48
+
+// 서버가 X-Request-ID 헤더로 보내는 추적 ID 최대 길이
+#define REQUEST_ID_MAX 64
+
+// httpd 태스크 스택 (기본 4096): 인증 헤더 버퍼, 시퀀스 명령 배열, cJSON 파싱이 같은 스택을 씀
+#define WEB_SERVER_STACK 8192
+
+// 명령 요청 추적 정보 (응답의 "trace"로 반환)
+typedef struct {
+    char id[REQUEST_ID_MAX];
+    ir_trace_t timing;
+} request_trace_t;
 
 // CORS 헤더 추가
 static void add_cors_headers(httpd_req_t *req)
 {
     httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
     httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
-    httpd_resp_set_hdr(req, "Access-Control-Allow-Headers", "Content-Type, Authorization");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Headers", "Content-Type, Authorization, X-Request-ID");
 }
 
-// API 키 검증
-static esp_err_t verify_api_key(httpd_req_t *req)
+// 핸들러 진입 시각 기록, 추적 ID는 응답 헤더로 되돌려 보냄
+static void trace_begin(httpd_req_t *req, request_trace_t *trace)
 {
-    char auth_header[256];
-    int ret = httpd_req_get_hdr_value_str(req, "Authorization", auth_header, sizeof(auth_header));
+    memset(trace, 0, sizeof(*trace));
+    trace->timing.received_us = esp_timer_get_time();
     
-    if (ret == ESP_OK) {
-        if (strncmp(auth_header, "Bearer ", 7) == 0) {
-            if (strcmp(auth_header + 7, API_KEY) == 0) {
-                return ESP_OK;
-            }
+    if (httpd_req_get_hdr_value_str(req, "X-Request-ID", trace->id, sizeof(trace->id)) == ESP_OK) {
+        httpd_resp_set_hdr(req, "X-Request-ID", trace->id);
+    } else {
+        trace->id[0] = '\0';
+    }
+}
+
+// 구간 타임스탬프 (부팅 후 마이크로초, 서버는 차이만 사용)
+static void add_trace(cJSON *response, const request_trace_t *trace)
+{
+    cJSON *json = cJSON_AddObjectToObject(response, "trace");
+    if (trace->id[0]) {
+        cJSON_AddStringToObject(json, "request_id", trace->id);
+    }
+    cJSON_AddNumberToObject(json, "received_us", trace->timing.received_us);
+    cJSON_AddNumberToObject(json, "dispatched_us", trace->timing.dispatched_us);
+    cJSON_AddNumberToObject(json, "first_frame_us", trace->timing.first_frame_us);
+    cJSON_AddNumberToObject(json, "completed_us", trace->timing.completed_us);
+}
+
+static bool parse_sha256_hex(const char *hex, uint8_t out[OTA_SHA256_LEN])
+{
+    if (strlen(hex) != OTA_SHA256_LEN * 2) {
+        return false;
+    }
+    for (int i = 0; i < OTA_SHA256_LEN; i++) {
+        unsigned int byte;
+        if (sscanf(hex + i * 2, "%2x", &byte) != 1) {
+            return false;
+        }
+        out[i] = (uint8_t)byte;
+    }
+    return true;
+}
+
+// 서명에 묶이는 헤더 읽기 (없으면 빈 문자열, 버퍼보다 길면 false)
+static bool get_bound_header(httpd_req_t *req, const char *name, char *buf, size_t size)
+{
+    esp_err_t err = httpd_req_get_hdr_value_str(req, name, buf, size);
+    if (err != ESP_OK) {
+        buf[0] = '\0';
+    }
+    return err != ESP_ERR_HTTPD_RESULT_TRUNC;
+}
+
+// 요청 인증 및 권한 확인
+// 실패하면 401(서명 요청에 필요한 부팅 ID 포함) 또는 403 응답을 보내고 false 반환
+// 서명 요청이면 본문이 서명된 X-Content-SHA256과 같은지 http_body가 받으면서 확인
+static bool require_scope(httpd_req_t *req, uint8_t scope)
+{
+    http_body_expect_sha256(NULL);
+    
+    char authorization[AUTH_HEADER_MAX];
+    bool has_header = httpd_req_get_hdr_value_str(req, "Authorization", authorization, sizeof(authorization)) == ESP_OK;
+    
+    char content_sha256[HTTP_BODY_SHA256_LEN * 2 + 1];
+    char image_sha256[OTA_SHA256_LEN * 2 + 1];
+    char content_range[BOUND_HEADER_MAX];
+    bool bound_ok = get_bound_header(req, "X-Content-SHA256", content_sha256, sizeof(content_sha256)) &&
+                    get_bound_header(req, "X-Image-SHA256", image_sha256, sizeof(image_sha256)) &&
+                    get_bound_header(req, "Content-Range", content_range, sizeof(content_range));
+    api_auth_bound_t bound = {
+        .content_sha256 = content_sha256,
+        .image_sha256 = image_sha256,
+        .content_range = content_range,
+    };
+    
+    api_auth_result_t result = bound_ok
+        ? api_auth_verify(http_method_str((enum http_method)req->method), req->uri,
+                          has_header ? authorization : NULL, &bound, scope)
+        : API_AUTH_UNAUTHORIZED;
+    if (result == API_AUTH_OK) {
+        uint8_t body_sha256[HTTP_BODY_SHA256_LEN];
+        if (strncmp(authorization, "HMAC ", 5) == 0 && parse_sha256_hex(content_sha256, body_sha256)) {
+            http_body_expect_sha256(body_sha256);
         }
+        return true;
     }
     
-    return ESP_FAIL;
+    if (result == API_AUTH_FORBIDDEN) {
+        httpd_resp_set_status(req, "403 Forbidden");
+    } else {
+        httpd_resp_set_status(req, "401 Unauthorized");
+        httpd_resp_set_hdr(req, "WWW-Authenticate", api_auth_challenge());
+    }
+    httpd_resp_send(req, NULL, 0);
+    return false;
 }
 
 // 상태 확인 API
@@ -44,9 +150,7 @@ static esp_err_t status_get_handler(httpd_req_t *req)
     
     add_cors_headers(req);
     
-    if (verify_api_key(req) != ESP_OK) {
-        httpd_resp_set_status(req, "401 Unauthorized");
-        httpd_resp_send(req, NULL, 0);
+    if (!require_scope(req, API_SCOPE_READ)) {
         return ESP_OK;
     }
     
@@ -81,9 +185,7 @@ static esp_err_t wifi_get_handler(httpd_req_t *req)
     
     add_cors_headers(req);
     
-    if (verify_api_key(req) != ESP_OK) {
-        httpd_resp_set_status(req, "401 Unauthorized");
-        httpd_resp_send(req, NULL, 0);
+    if (!require_scope(req, API_SCOPE_READ)) {
         return ESP_OK;
     }
     
@@ -112,33 +214,25 @@ static esp_err_t aircon_power_post_handler(httpd_req_t *req)
 {
     ESP_LOGI(TAG, "에어컨 전원 제어 요청");
     
+    request_trace_t trace;
+    trace_begin(req, &trace);
     add_cors_headers(req);
     
-    if (verify_api_key(req) != ESP_OK) {
-        httpd_resp_set_status(req, "401 Unauthorized");
-        httpd_resp_send(req, NULL, 0);
+    if (!require_scope(req, API_SCOPE_CONTROL)) {
         return ESP_OK;
     }
     
-    char content[100];
-    int ret = httpd_req_recv(req, content, sizeof(content) - 1);
-    if (ret <= 0) {
-        httpd_resp_send_500(req);
-        return ESP_FAIL;
-    }
-    content[ret] = '\0';
-    
-    cJSON *json = cJSON_Parse(content);
-    if (!json) {
-        httpd_resp_send_500(req);
-        return ESP_FAIL;
+    cJSON *json = NULL;
+    esp_err_t err = http_body_read_json(req, BODY_LIMIT_COMMAND, &json);
+    if (err != ESP_OK) {
+        return http_body_handler_result(err);
     }
     
     cJSON *power = cJSON_GetObjectItem(json, "power");
     if (!power || !cJSON_IsString(power)) {
         cJSON_Delete(json);
-        httpd_resp_send_500(req);
-        return ESP_FAIL;
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "잘못된 요청 파라미터");
+        return ESP_OK;
     }
     
     aircon_command_t command;
@@ -148,11 +242,11 @@ static esp_err_t aircon_power_post_handler(httpd_req_t *req)
         command = AIRCON_POWER_OFF;
     } else {
         cJSON_Delete(json);
-        httpd_resp_send_500(req);
-        return ESP_FAIL;
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "잘못된 요청 파라미터");
+        return ESP_OK;
     }
     
-    esp_err_t err = ir_controller_send_command(command);
+    err = ir_controller_send_command_traced(command, &trace.timing);
     
     cJSON *response = cJSON_CreateObject();
     if (err == ESP_OK) {
@@ -163,6 +257,8 @@ static esp_err_t aircon_power_post_handler(httpd_req_t *req)
         cJSON_AddStringToObject(response, "message", "명령 전송 실패");
     }
     
+    add_trace(response, &trace);
+    
     char *response_str = cJSON_Print(response);
     httpd_resp_set_type(req, "application/json");
     httpd_resp_send(req, response_str, strlen(response_str));
@@ -179,33 +275,25 @@ static esp_err_t aircon_temp_post_handler(httpd_req_t *req)
 {
     ESP_LOGI(TAG, "에어컨 온도 제어 요청");
     
+    request_trace_t trace;
+    trace_begin(req, &trace);
     add_cors_headers(req);
     
-    if (verify_api_key(req) != ESP_OK) {
-        httpd_resp_set_status(req, "401 Unauthorized");
-        httpd_resp_send(req, NULL, 0);
+    if (!require_scope(req, API_SCOPE_CONTROL)) {
         return ESP_OK;
     }
     
-    char content[100];
-    int ret = httpd_req_recv(req, content, sizeof(content) - 1);
-    if (ret <= 0) {
-        httpd_resp_send_500(req);
-        return ESP_FAIL;
-    }
-    content[ret] = '\0';
-    
-    cJSON *json = cJSON_Parse(content);
-    if (!json) {
-        httpd_resp_send_500(req);
-        return ESP_FAIL;
+    cJSON *json = NULL;
+    esp_err_t err = http_body_read_json(req, BODY_LIMIT_COMMAND, &json);
+    if (err != ESP_OK) {
+        return http_body_handler_result(err);
     }
     
     cJSON *action = cJSON_GetObjectItem(json, "action");
     if (!action || !cJSON_IsString(action)) {
         cJSON_Delete(json);
-        httpd_resp_send_500(req);
-        return ESP_FAIL;
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "잘못된 요청 파라미터");
+        return ESP_OK;
     }
     
     aircon_command_t command;
@@ -215,11 +303,11 @@ static esp_err_t aircon_temp_post_handler(httpd_req_t *req)
         command = AIRCON_TEMP_DOWN;
     } else {
         cJSON_Delete(json);
-        httpd_resp_send_500(req);
-        return ESP_FAIL;
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "잘못된 요청 파라미터");
+        return ESP_OK;
     }
     
-    esp_err_t err = ir_controller_send_command(command);
+    err = ir_controller_send_command_traced(command, &trace.timing);
     
     cJSON *response = cJSON_CreateObject();
     if (err == ESP_OK) {
@@ -230,6 +318,8 @@ static esp_err_t aircon_temp_post_handler(httpd_req_t *req)
         cJSON_AddStringToObject(response, "message", "명령 전송 실패");
     }
     
+    add_trace(response, &trace);
+    
     char *response_str = cJSON_Print(response);
     httpd_resp_set_type(req, "application/json");
     httpd_resp_send(req, response_str, strlen(response_str));
@@ -246,33 +336,25 @@ static esp_err_t aircon_mode_post_handler(httpd_req_t *req)
 {
     ESP_LOGI(TAG, "에어컨 모드 제어 요청");
     
+    request_trace_t trace;
+    trace_begin(req, &trace);
     add_cors_headers(req);
     
-    if (verify_api_key(req) != ESP_OK) {
-        httpd_resp_set_status(req, "401 Unauthorized");
-        httpd_resp_send(req, NULL, 0);
+    if (!require_scope(req, API_SCOPE_CONTROL)) {
         return ESP_OK;
     }
     
-    char content[100];
-    int ret = httpd_req_recv(req, content, sizeof(content) - 1);
-    if (ret <= 0) {
-        httpd_resp_send_500(req);
-        return ESP_FAIL;
-    }
-    content[ret] = '\0';
-    
-    cJSON *json = cJSON_Parse(content);
-    if (!json) {
-        httpd_resp_send_500(req);
-        return ESP_FAIL;
+    cJSON *json = NULL;
+    esp_err_t err = http_body_read_json(req, BODY_LIMIT_COMMAND, &json);
+    if (err != ESP_OK) {
+        return http_body_handler_result(err);
     }
     
     cJSON *mode = cJSON_GetObjectItem(json, "mode");
     if (!mode || !cJSON_IsString(mode)) {
         cJSON_Delete(json);
-        httpd_resp_send_500(req);
-        return ESP_FAIL;
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "잘못된 요청 파라미터");
+        return ESP_OK;
     }
     
     aircon_command_t command;
@@ -284,11 +366,11 @@ static esp_err_t aircon_mode_post_handler(httpd_req_t *req)
         command = AIRCON_MODE_FAN;
     } else {
         cJSON_Delete(json);
-        httpd_resp_send_500(req);
-        return ESP_FAIL;
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "잘못된 요청 파라미터");
+        return ESP_OK;
     }
     
-    esp_err_t err = ir_controller_send_command(command);
+    err = ir_controller_send_command_traced(command, &trace.timing);
     
     cJSON *response = cJSON_CreateObject();
     if (err == ESP_OK) {
@@ -299,6 +381,91 @@ static esp_err_t aircon_mode_post_handler(httpd_req_t *req)
         cJSON_AddStringToObject(response, "message", "명령 전송 실패");
     }
     
+    add_trace(response, &trace);
+    
+    char *response_str = cJSON_Print(response);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, response_str, strlen(response_str));
+    
+    free(response_str);
+    cJSON_Delete(response);
+    cJSON_Delete(json);
+    
+    return ESP_OK;
+}
+
+// 에어컨 명령 시퀀스 API (서버 플래너가 계산한 명령들을 한 번의 요청으로 전송)
+// body: {"steps": [{"command": "power_on"}, {"command": "temp_down", "count": 4}], "gap_ms": 0}
+static esp_err_t aircon_sequence_post_handler(httpd_req_t *req)
+{
+    ESP_LOGI(TAG, "에어컨 명령 시퀀스 요청");
+    
+    request_trace_t trace;
+    trace_begin(req, &trace);
+    add_cors_headers(req);
+    
+    if (!require_scope(req, API_SCOPE_CONTROL)) {
+        return ESP_OK;
+    }
+    
+    cJSON *json = NULL;
+    esp_err_t err = http_body_read_json(req, BODY_LIMIT_SEQUENCE, &json);
+    if (err != ESP_OK) {
+        return http_body_handler_result(err);
+    }
+    
+    // 단계를 명령 배열로 펼침 (count만큼 반복)
+    aircon_command_t commands[IR_SEQUENCE_MAX];
+    size_t count = 0;
+    bool valid = true;
+    
+    cJSON *steps = cJSON_GetObjectItem(json, "steps");
+    cJSON *step;
+    if (!cJSON_IsArray(steps)) {
+        valid = false;
+    } else {
+        cJSON_ArrayForEach(step, steps) {
+            cJSON *name = cJSON_GetObjectItem(step, "command");
+            cJSON *repeat = cJSON_GetObjectItem(step, "count");
+            int times = cJSON_IsNumber(repeat) ? repeat->valueint : 1;
+            aircon_command_t command;
+            
+            if (!cJSON_IsString(name) || ir_controller_parse_command(name->valuestring, &command) != ESP_OK ||
+                times < 1 || count + times > IR_SEQUENCE_MAX) {
+                valid = false;
+                break;
+            }
+            for (int i = 0; i < times; i++) {
+                commands[count++] = command;
+            }
+        }
+    }
+    
+    cJSON *gap = cJSON_GetObjectItem(json, "gap_ms");
+    uint32_t gap_ms = cJSON_IsNumber(gap) && gap->valueint > 0 ? gap->valueint : 0;
+    if (!valid || count == 0 || gap_ms > 1000) {
+        cJSON_Delete(json);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "잘못된 요청 파라미터");
+        return ESP_OK;
+    }
+    
+    size_t sent = 0;
+    err = ir_controller_send_sequence(commands, count, gap_ms, &sent, &trace.timing);
+    
+    cJSON *response = cJSON_CreateObject();
+    if (err == ESP_OK) {
+        cJSON_AddStringToObject(response, "status", "success");
+        cJSON_AddStringToObject(response, "message", "명령 시퀀스가 전송되었습니다");
+    } else {
+        cJSON_AddStringToObject(response, "status", "error");
+        cJSON_AddStringToObject(response, "message", "명령 전송 실패");
+    }
+    // 서버는 전송된 명령 수만큼만 상태 모델에 반영
+    cJSON_AddNumberToObject(response, "executed", sent);
+    cJSON_AddNumberToObject(response, "total", count);
+    
+    add_trace(response, &trace);
+    
     char *response_str = cJSON_Print(response);
     httpd_resp_set_type(req, "application/json");
     httpd_resp_send(req, response_str, strlen(response_str));
@@ -317,24 +484,14 @@ static esp_err_t config_wifi_post_handler(httpd_req_t *req)
     
     add_cors_headers(req);
     
-    if (verify_api_key(req) != ESP_OK) {
-        httpd_resp_set_status(req, "401 Unauthorized");
-        httpd_resp_send(req, NULL, 0);
+    if (!require_scope(req, API_SCOPE_ADMIN)) {
         return ESP_OK;
     }
     
-    char content[200];
-    int ret = httpd_req_recv(req, content, sizeof(content) - 1);
-    if (ret <= 0) {
-        httpd_resp_send_500(req);
-        return ESP_FAIL;
-    }
-    content[ret] = '\0';
-    
-    cJSON *json = cJSON_Parse(content);
-    if (!json) {
-        httpd_resp_send_500(req);
-        return ESP_FAIL;
+    cJSON *json = NULL;
+    esp_err_t err = http_body_read_json(req, BODY_LIMIT_CONFIG, &json);
+    if (err != ESP_OK) {
+        return http_body_handler_result(err);
     }
     
     cJSON *ssid = cJSON_GetObjectItem(json, "ssid");
@@ -342,15 +499,15 @@ static esp_err_t config_wifi_post_handler(httpd_req_t *req)
     
     if (!ssid || !password || !cJSON_IsString(ssid) || !cJSON_IsString(password)) {
         cJSON_Delete(json);
-        httpd_resp_send_500(req);
-        return ESP_FAIL;
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "잘못된 요청 파라미터");
+        return ESP_OK;
     }
     
     wifi_config_t config;
     strncpy(config.ssid, ssid->valuestring, sizeof(config.ssid) - 1);
     strncpy(config.password, password->valuestring, sizeof(config.password) - 1);
     
-    esp_err_t err = wifi_manager_save_config(&config);
+    err = wifi_manager_save_config(&config);
     if (err == ESP_OK) {
         err = wifi_manager_connect(config.ssid, config.password);
     }
@@ -382,9 +539,7 @@ static esp_err_t config_get_handler(httpd_req_t *req)
     
     add_cors_headers(req);
     
-    if (verify_api_key(req) != ESP_OK) {
-        httpd_resp_set_status(req, "401 Unauthorized");
-        httpd_resp_send(req, NULL, 0);
+    if (!require_scope(req, API_SCOPE_READ)) {
         return ESP_OK;
     }
     
@@ -407,6 +562,539 @@ static esp_err_t config_get_handler(httpd_req_t *req)
     return ESP_OK;
 }
 
+// IR 코드 라이브러리 정보 API
+static esp_err_t ir_library_get_handler(httpd_req_t *req)
+{
+    ESP_LOGI(TAG, "IR 코드 라이브러리 조회 요청");
+    
+    add_cors_headers(req);
+    
+    if (!require_scope(req, API_SCOPE_READ)) {
+        return ESP_OK;
+    }
+    
+    cJSON *response = cJSON_CreateObject();
+    
+    ir_library_info_t info;
+    if (ir_code_library_get_info(&info) == ESP_OK) {
+        cJSON_AddNumberToObject(response, "models", info.model_count);
+        cJSON_AddNumberToObject(response, "codes", info.code_count);
+        cJSON_AddNumberToObject(response, "size", info.size);
+        cJSON_AddNumberToObject(response, "partition_size", info.partition_size);
+        cJSON_AddNumberToObject(response, "max_size", info.max_size);
+    } else {
+        cJSON_AddStringToObject(response, "error", "IR 코드 파티션 없음");
+    }
+    
+    char brand[IR_MODEL_NAME_MAX];
+    char model[IR_MODEL_NAME_MAX];
+    ir_controller_get_model(brand, sizeof(brand), model, sizeof(model));
+    cJSON_AddStringToObject(response, "brand", brand);
+    cJSON_AddStringToObject(response, "model", model);
+    
+    char *response_str = cJSON_Print(response);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, response_str, strlen(response_str));
+    
+    free(response_str);
+    cJSON_Delete(response);
+    
+    return ESP_OK;
+}
+
+static esp_err_t ir_library_chunk_cb(const char *data, size_t len, void *ctx)
+{
+    return ir_code_library_update_write(data, len);
+}
+
+// IR 코드 라이브러리 업로드 API (application/octet-stream, pack-ir-library.js 출력)
+static esp_err_t ir_library_post_handler(httpd_req_t *req)
+{
+    ESP_LOGI(TAG, "IR 코드 라이브러리 업로드 요청 (%u 바이트)", (unsigned)req->content_len);
+    
+    add_cors_headers(req);
+    
+    if (!require_scope(req, API_SCOPE_ADMIN)) {
+        return ESP_OK;
+    }
+    
+    // 본문 한도는 A/B 슬롯 하나에 담을 수 있는 크기 (파티션 크기에서 계산)
+    ir_library_info_t info;
+    esp_err_t err = ir_code_library_get_info(&info);
+    if (err != ESP_OK) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    
+    if (req->content_len > info.max_size) {
+        ESP_LOGW(TAG, "IR 코드 라이브러리 크기 초과 (%u > %u)", (unsigned)req->content_len, (unsigned)info.max_size);
+        httpd_resp_set_status(req, "413 Payload Too Large");
+        httpd_resp_send(req, NULL, 0);
+        return ESP_OK;
+    }
+    
+    err = ir_code_library_update_begin(req->content_len);
+    if (err == ESP_ERR_INVALID_SIZE) {
+        httpd_resp_set_status(req, "413 Payload Too Large");
+        httpd_resp_send(req, NULL, 0);
+        return ESP_OK;
+    } else if (err != ESP_OK) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    
+    // 청크 단위로 받아 바로 파티션에 기록
+    err = http_body_stream(req, info.max_size, ir_library_chunk_cb, NULL);
+    if (err != ESP_OK) {
+        // 본문 해시 불일치도 여기서 걸러지므로 검증/커밋하지 않고 버림
+        ir_code_library_update_abort();
+        return http_body_handler_result(err);
+    }
+    
+    err = ir_code_library_update_end();
+    
+    cJSON *response = cJSON_CreateObject();
+    if (err == ESP_OK) {
+        ir_library_info_t info;
+        ir_code_library_get_info(&info);
+        cJSON_AddStringToObject(response, "status", "success");
+        cJSON_AddNumberToObject(response, "models", info.model_count);
+        cJSON_AddNumberToObject(response, "codes", info.code_count);
+    } else {
+        httpd_resp_set_status(req, "400 Bad Request");
+        cJSON_AddStringToObject(response, "status", "error");
+        cJSON_AddStringToObject(response, "message", "라이브러리 검증 실패");
+    }
+    
+    char *response_str = cJSON_Print(response);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, response_str, strlen(response_str));
+    
+    free(response_str);
+    cJSON_Delete(response);
+    
+    return ESP_OK;
+}
+
+// IR 코드 모델 선택 API
+static esp_err_t ir_model_post_handler(httpd_req_t *req)
+{
+    ESP_LOGI(TAG, "IR 모델 선택 요청");
+    
+    add_cors_headers(req);
+    
+    if (!require_scope(req, API_SCOPE_ADMIN)) {
+        return ESP_OK;
+    }
+    
+    cJSON *json = NULL;
+    esp_err_t err = http_body_read_json(req, BODY_LIMIT_COMMAND, &json);
+    if (err != ESP_OK) {
+        return http_body_handler_result(err);
+    }
+    
+    cJSON *brand = cJSON_GetObjectItem(json, "brand");
+    cJSON *model = cJSON_GetObjectItem(json, "model");
+    if (!brand || !model || !cJSON_IsString(brand) || !cJSON_IsString(model)) {
+        cJSON_Delete(json);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "잘못된 요청 파라미터");
+        return ESP_OK;
+    }
+    
+    err = ir_controller_select_model(brand->valuestring, model->valuestring);
+    
+    cJSON *response = cJSON_CreateObject();
+    if (err == ESP_OK) {
+        cJSON_AddStringToObject(response, "status", "success");
+        cJSON_AddStringToObject(response, "message", "모델이 선택되었습니다");
+    } else {
+        httpd_resp_set_status(req, err == ESP_ERR_NOT_FOUND ? "404 Not Found" : "400 Bad Request");
+        cJSON_AddStringToObject(response, "status", "error");
+        cJSON_AddStringToObject(response, "message", "라이브러리에 없는 모델입니다");
+    }
+    
+    char *response_str = cJSON_Print(response);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, response_str, strlen(response_str));
+    
+    free(response_str);
+    cJSON_Delete(response);
+    cJSON_Delete(json);
+    
+    return ESP_OK;
+}
+
+static void ota_restart_cb(void *arg)
+{
+    esp_restart();
+}
+
+// 응답 전송 후 재부팅되도록 잠시 뒤 재시작
+static void schedule_restart(void)
+{
+    const esp_timer_create_args_t args = {
+        .callback = ota_restart_cb,
+        .name = "ota_restart"
+    };
+    esp_timer_handle_t timer;
+    if (esp_timer_create(&args, &timer) == ESP_OK) {
+        esp_timer_start_once(timer, 1000 * 1000);
+    }
+}
+
+static void add_ota_status(cJSON *response)
+{
+    ota_status_t status;
+    ota_updater_get_status(&status);
+
+    char sha_hex[OTA_SHA256_LEN * 2 + 1] = {0};
+    for (int i = 0; i < OTA_SHA256_LEN; i++) {
+        sprintf(sha_hex + i * 2, "%02x", status.sha256[i]);
+    }
+
+    cJSON_AddStringToObject(response, "version", esp_app_get_description()->version);
+    cJSON_AddStringToObject(response, "running_partition", status.running_partition);
+    cJSON_AddStringToObject(response, "target_partition", status.target_partition);
+    cJSON_AddBoolToObject(response, "pending_verify", status.pending_verify);
+    cJSON_AddBoolToObject(response, "active", status.active);
+    cJSON_AddNumberToObject(response, "image_size", status.image_size);
+    cJSON_AddNumberToObject(response, "received", status.received);
+    cJSON_AddStringToObject(response, "sha256", status.active ? sha_hex : "");
+}
+
+// 수신한 청크를 이어서 OTA 파티션에 기록
+static esp_err_t ota_chunk_cb(const char *data, size_t len, void *ctx)
+{
+    size_t *offset = ctx;
+    esp_err_t err = ota_updater_write(*offset, data, len);
+    if (err == ESP_OK) {
+        *offset += len;
+    }
+    return err;
+}
+
+// OTA 상태 조회 API (재개 위치 확인용)
+static esp_err_t ota_get_handler(httpd_req_t *req)
+{
+    add_cors_headers(req);
+    
+    if (!require_scope(req, API_SCOPE_READ)) {
+        return ESP_OK;
+    }
+    
+    cJSON *response = cJSON_CreateObject();
+    add_ota_status(response);
+    
+    char *response_str = cJSON_Print(response);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, response_str, strlen(response_str));
+    
+    free(response_str);
+    cJSON_Delete(response);
+    
+    return ESP_OK;
+}
+
+// OTA 이미지 수신 API
+// 헤더: X-Image-SHA256 (필수), Content-Range: bytes <시작>-<끝>/<전체> (이어받기 시)
+static esp_err_t ota_post_handler(httpd_req_t *req)
+{
+    ESP_LOGI(TAG, "OTA 업데이트 요청 (%u 바이트)", (unsigned)req->content_len);
+    
+    add_cors_headers(req);
+    
+    if (!require_scope(req, API_SCOPE_ADMIN)) {
+        return ESP_OK;
+    }
+    
+    char header[80];
+    uint8_t sha256[OTA_SHA256_LEN];
+    if (httpd_req_get_hdr_value_str(req, "X-Image-SHA256", header, sizeof(header)) != ESP_OK ||
+        !parse_sha256_hex(header, sha256)) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "X-Image-SHA256 헤더가 필요합니다");
+        return ESP_OK;
+    }
+    
+    size_t start = 0;
+    size_t total = req->content_len;
+    if (httpd_req_get_hdr_value_str(req, "Content-Range", header, sizeof(header)) == ESP_OK) {
+        unsigned int range_start, range_end, range_total;
+        if (sscanf(header, "bytes %u-%u/%u", &range_start, &range_end, &range_total) != 3 ||
+            range_end < range_start || range_end - range_start + 1 != req->content_len) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "잘못된 Content-Range");
+            return ESP_OK;
+        }
+        start = range_start;
+        total = range_total;
+    }
+    
+    size_t resume_offset;
+    esp_err_t err = ota_updater_begin(total, sha256, &resume_offset);
+    if (err == ESP_ERR_INVALID_SIZE) {
+        httpd_resp_set_status(req, "413 Payload Too Large");
+        httpd_resp_send(req, NULL, 0);
+        return ESP_OK;
+    } else if (err != ESP_OK) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    
+    cJSON *response = cJSON_CreateObject();
+    
+    if (start != resume_offset) {
+        // 클라이언트는 received 위치부터 다시 보내야 함
+        httpd_resp_set_status(req, "409 Conflict");
+        cJSON_AddStringToObject(response, "status", "error");
+        cJSON_AddStringToObject(response, "message", "재개 위치 불일치");
+    } else {
+        // 이미지 전체를 버퍼링하지 않고 HTTP_BODY_CHUNK_SIZE 단위로 바로 기록
+        size_t offset = start;
+        err = http_body_stream(req, BODY_LIMIT_OTA, ota_chunk_cb, &offset);
+        if (err == ESP_ERR_INVALID_CRC) {
+            // 서명되지 않은 데이터가 이미 기록됐으므로 이어받지 않고 세션을 버림
+            ESP_LOGW(TAG, "OTA 본문 해시 불일치, 세션 취소");
+            ota_updater_abort();
+            cJSON_Delete(response);
+            return ESP_OK;
+        } else if (err != ESP_OK) {
+            // 연결이 끊겨도 세션은 유지되므로 다음 요청에서 이어받기
+            ESP_LOGW(TAG, "OTA 수신 중단: %u 바이트 수신", (unsigned)(offset - start));
+            cJSON_Delete(response);
+            return http_body_handler_result(err);
+        }
+        
+        if (offset < total) {
+            httpd_resp_set_status(req, "202 Accepted");
+            cJSON_AddStringToObject(response, "status", "partial");
+        } else {
+            err = ota_updater_finish();
+            if (err == ESP_OK) {
+                cJSON_AddStringToObject(response, "status", "success");
+                cJSON_AddStringToObject(response, "message", "업데이트 완료, 재부팅합니다");
+                schedule_restart();
+            } else {
+                httpd_resp_set_status(req, "422 Unprocessable Entity");
+                cJSON_AddStringToObject(response, "status", "error");
+                cJSON_AddStringToObject(response, "message",
+                    err == ESP_ERR_INVALID_CRC ? "SHA-256 불일치" : "이미지 검증 실패");
+            }
+        }
+    }
+    
+    add_ota_status(response);
+    
+    char *response_str = cJSON_Print(response);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, response_str, strlen(response_str));
+    
+    free(response_str);
+    cJSON_Delete(response);
+    
+    return ESP_OK;
+}
+
+// OTA 세션 취소 API
+static esp_err_t ota_abort_post_handler(httpd_req_t *req)
+{
+    add_cors_headers(req);
+    
+    if (!require_scope(req, API_SCOPE_ADMIN)) {
+        return ESP_OK;
+    }
+    
+    ota_updater_abort();
+    
+    cJSON *response = cJSON_CreateObject();
+    cJSON_AddStringToObject(response, "status", "success");
+    add_ota_status(response);
+    
+    char *response_str = cJSON_Print(response);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, response_str, strlen(response_str));
+    
+    free(response_str);
+    cJSON_Delete(response);
+    
+    return ESP_OK;
+}
+
+// 권한 이름 ↔ 비트
+static const struct {
+    const char *name;
+    uint8_t bit;
+} scope_names[] = {
+    { "read", API_SCOPE_READ },
+    { "control", API_SCOPE_CONTROL },
+    { "admin", API_SCOPE_ADMIN }
+};
+
+static cJSON *scopes_to_json(uint8_t scopes)
+{
+    cJSON *array = cJSON_CreateArray();
+    for (int i = 0; i < sizeof(scope_names) / sizeof(scope_names[0]); i++) {
+        if (scopes & scope_names[i].bit) {
+            cJSON_AddItemToArray(array, cJSON_CreateString(scope_names[i].name));
+        }
+    }
+    return array;
+}
+
+// 알 수 없는 권한 이름이 있으면 0
+static uint8_t scopes_from_json(const cJSON *array)
+{
+    uint8_t scopes = 0;
+    const cJSON *item;
+    cJSON_ArrayForEach(item, array) {
+        uint8_t bit = 0;
+        for (int i = 0; cJSON_IsString(item) && i < sizeof(scope_names) / sizeof(scope_names[0]); i++) {
+            if (strcmp(item->valuestring, scope_names[i].name) == 0) {
+                bit = scope_names[i].bit;
+            }
+        }
+        if (bit == 0) {
+            return 0;
+        }
+        scopes |= bit;
+    }
+    return scopes;
+}
+
+// 키 변경 결과 응답
+static void send_key_result(httpd_req_t *req, esp_err_t err, const char *success_message)
+{
+    cJSON *response = cJSON_CreateObject();
+    cJSON_AddStringToObject(response, "status", err == ESP_OK ? "success" : "error");
+    
+    if (err == ESP_OK) {
+        cJSON_AddStringToObject(response, "message", success_message);
+    } else if (err == ESP_ERR_NOT_FOUND) {
+        httpd_resp_set_status(req, "404 Not Found");
+        cJSON_AddStringToObject(response, "message", "등록되지 않은 키입니다");
+    } else if (err == ESP_ERR_INVALID_STATE) {
+        httpd_resp_set_status(req, "409 Conflict");
+        cJSON_AddStringToObject(response, "message", "관리자 권한 키가 최소 하나는 있어야 합니다");
+    } else if (err == ESP_ERR_NO_MEM) {
+        httpd_resp_set_status(req, "409 Conflict");
+        cJSON_AddStringToObject(response, "message", "등록할 수 있는 키 개수를 초과했습니다");
+    } else if (err == ESP_ERR_INVALID_ARG) {
+        httpd_resp_set_status(req, "400 Bad Request");
+        cJSON_AddStringToObject(response, "message", "키 ID(영문/숫자/_-, 15자 이하), 키(16~128자), 권한을 확인하세요");
+    } else {
+        httpd_resp_set_status(req, "500 Internal Server Error");
+        cJSON_AddStringToObject(response, "message", "키 저장 실패");
+    }
+    
+    char *response_str = cJSON_Print(response);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, response_str, strlen(response_str));
+    
+    free(response_str);
+    cJSON_Delete(response);
+}
+
+// 인증 정보 조회 API: 부팅 ID, 키 목록(해시 제외), 인증 방식별 검증 비용
+static esp_err_t auth_get_handler(httpd_req_t *req)
+{
+    add_cors_headers(req);
+    
+    if (!require_scope(req, API_SCOPE_ADMIN)) {
+        return ESP_OK;
+    }
+    
+    api_key_info_t keys[API_AUTH_KEYS_MAX];
+    size_t key_count = api_auth_list_keys(keys, API_AUTH_KEYS_MAX);
+    api_auth_stats_t stats[API_AUTH_MODE_COUNT];
+    api_auth_get_stats(stats);
+    
+    cJSON *response = cJSON_CreateObject();
+    char boot_id[9];
+    snprintf(boot_id, sizeof(boot_id), "%08" PRIx32, api_auth_boot_id());
+    cJSON_AddStringToObject(response, "boot_id", boot_id);
+    
+    cJSON *key_list = cJSON_AddArrayToObject(response, "keys");
+    for (size_t i = 0; i < key_count; i++) {
+        cJSON *key = cJSON_CreateObject();
+        cJSON_AddStringToObject(key, "id", keys[i].id);
+        cJSON_AddItemToObject(key, "scopes", scopes_to_json(keys[i].scopes));
+        cJSON_AddBoolToObject(key, "hmac_only", keys[i].flags & API_KEY_FLAG_HMAC_ONLY);
+        cJSON_AddBoolToObject(key, "legacy", keys[i].flags & API_KEY_FLAG_LEGACY);
+        cJSON_AddItemToArray(key_list, key);
+    }
+    
+    static const char *mode_names[API_AUTH_MODE_COUNT] = { "bearer", "hmac" };
+    cJSON *stats_json = cJSON_AddObjectToObject(response, "stats");
+    for (int i = 0; i < API_AUTH_MODE_COUNT; i++) {
+        cJSON *mode = cJSON_AddObjectToObject(stats_json, mode_names[i]);
+        cJSON_AddNumberToObject(mode, "count", stats[i].count);
+        cJSON_AddNumberToObject(mode, "failed", stats[i].failed);
+        cJSON_AddNumberToObject(mode, "mean_us", stats[i].count ? (double)stats[i].total_us / stats[i].count : 0);
+        cJSON_AddNumberToObject(mode, "max_us", stats[i].max_us);
+    }
+    
+    char *response_str = cJSON_Print(response);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, response_str, strlen(response_str));
+    
+    free(response_str);
+    cJSON_Delete(response);
+    
+    return ESP_OK;
+}
+
+// 키 추가/교체 API
+// 본문: {"id": "server", "key": "<16~128자>", "scopes": ["read", "control"], "hmac_only": true}
+static esp_err_t auth_key_post_handler(httpd_req_t *req)
+{
+    add_cors_headers(req);
+    
+    if (!require_scope(req, API_SCOPE_ADMIN)) {
+        return ESP_OK;
+    }
+    
+    cJSON *json = NULL;
+    esp_err_t err = http_body_read_json(req, BODY_LIMIT_CONFIG, &json);
+    if (err != ESP_OK) {
+        return http_body_handler_result(err);
+    }
+    
+    cJSON *id = cJSON_GetObjectItem(json, "id");
+    cJSON *key = cJSON_GetObjectItem(json, "key");
+    cJSON *scopes = cJSON_GetObjectItem(json, "scopes");
+    if (!cJSON_IsString(id) || !cJSON_IsString(key) || !cJSON_IsArray(scopes)) {
+        cJSON_Delete(json);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "잘못된 요청 파라미터");
+        return ESP_OK;
+    }
+    
+    uint8_t flags = cJSON_IsTrue(cJSON_GetObjectItem(json, "hmac_only")) ? API_KEY_FLAG_HMAC_ONLY : 0;
+    err = api_auth_set_key(id->valuestring, key->valuestring, scopes_from_json(scopes), flags);
+    cJSON_Delete(json);
+    
+    send_key_result(req, err, "키가 저장되었습니다");
+    return ESP_OK;
+}
+
+// 키 삭제 API: DELETE /api/auth/keys?id=<키 ID>
+static esp_err_t auth_key_delete_handler(httpd_req_t *req)
+{
+    add_cors_headers(req);
+    
+    if (!require_scope(req, API_SCOPE_ADMIN)) {
+        return ESP_OK;
+    }
+    
+    char query[64];
+    char id[API_AUTH_KEY_ID_MAX];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK ||
+        httpd_query_key_value(query, "id", id, sizeof(id)) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "id 파라미터가 필요합니다");
+        return ESP_OK;
+    }
+    
+    send_key_result(req, api_auth_delete_key(id), "키가 삭제되었습니다");
+    return ESP_OK;
+}
+
 // URL 핸들러 등록
 static const httpd_uri_t uri_handlers[] = {
     {
@@ -439,6 +1127,12 @@ static const httpd_uri_t uri_handlers[] = {
         .handler = aircon_mode_post_handler,
         .user_ctx = NULL
     },
+    {
+        .uri = "/api/aircon/sequence",
+        .method = HTTP_POST,
+        .handler = aircon_sequence_post_handler,
+        .user_ctx = NULL
+    },
     {
         .uri = "/api/config/wifi",
         .method = HTTP_POST,
@@ -450,6 +1144,60 @@ static const httpd_uri_t uri_handlers[] = {
         .method = HTTP_GET,
         .handler = config_get_handler,
         .user_ctx = NULL
+    },
+    {
+        .uri = "/api/ir/library",
+        .method = HTTP_GET,
+        .handler = ir_library_get_handler,
+        .user_ctx = NULL
+    },
+    {
+        .uri = "/api/ir/library",
+        .method = HTTP_POST,
+        .handler = ir_library_post_handler,
+        .user_ctx = NULL
+    },
+    {
+        .uri = "/api/ir/model",
+        .method = HTTP_POST,
+        .handler = ir_model_post_handler,
+        .user_ctx = NULL
+    },
+    {
+        .uri = "/api/ota",
+        .method = HTTP_GET,
+        .handler = ota_get_handler,
+        .user_ctx = NULL
+    },
+    {
+        .uri = "/api/ota",
+        .method = HTTP_POST,
+        .handler = ota_post_handler,
+        .user_ctx = NULL
+    },
+    {
+        .uri = "/api/ota/abort",
+        .method = HTTP_POST,
+        .handler = ota_abort_post_handler,
+        .user_ctx = NULL
+    },
+    {
+        .uri = "/api/auth",
+        .method = HTTP_GET,
+        .handler = auth_get_handler,
+        .user_ctx = NULL
+    },
+    {
+        .uri = "/api/auth/keys",
+        .method = HTTP_POST,
+        .handler = auth_key_post_handler,
+        .user_ctx = NULL
+    },
+    {
+        .uri = "/api/auth/keys",
+        .method = HTTP_DELETE,
+        .handler = auth_key_delete_handler,
+        .user_ctx = NULL
     }
 };
 
@@ -460,6 +1208,7 @@ esp_err_t web_server_start(void)
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.port = 80;
     config.max_uri_handlers = 20;
+    config.stack_size = WEB_SERVER_STACK;
     
     esp_err_t ret = httpd_start(&server, &config);
     if (ret != ESP_OK) {
@@ -3,6 +3,10 @@
 
 #include "esp_err.h"
 
+// 기본 API 키: 키 저장소(api_auth)에 등록된 키가 없을 때 모든 권한으로 사용
+// 운영 시에는 POST /api/auth/keys로 권한별 키를 등록한 뒤 이 키("default")를 삭제
+#define API_KEY "aircon_control_2024"
+
 // 웹 서버 함수들
 esp_err_t web_server_start(void);
 esp_err_t web_server_stop(void);
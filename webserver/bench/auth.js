@@ -0,0 +1,110 @@
+// 디바이스 인증 방식별 비용 벤치마크 (Bearer vs 서명 요청)
+// 사용법: node bench/auth.js [요청 수]
+//         node bench/auth.js [요청 수] --device 192.168.1.100 [--port 80] [--key <API 키>] [--key-id default]
+// --device가 없으면 시뮬레이터 한 대를 띄워 측정한다.
+// 인증 방식마다 GET /api/status를 순차 전송하고 다음을 보고한다.
+// - rtt_ms: 서버에서 측정한 왕복 시간 (서명 생성 포함, keep-alive 연결 재사용 기준)
+// - device_auth_us: 디바이스가 요청 하나를 검증하는 데 쓴 시간 (GET /api/auth 통계의 측정 전후 차이)
+//   Bearer는 SHA-256 한 번 + 키 개수만큼 해시 비교, 서명은 HMAC-SHA256 한 번 + 서명 비교
+// - sign_us: 서버가 서명 헤더를 만드는 시간
+// 관리자 권한 키가 필요하다 (GET /api/auth).
+const deviceClient = require('../src/utils/deviceClient');
+const { summarize } = require('../src/utils/stats');
+const { startDevices } = require('../tools/device-simulator');
+
+const args = process.argv.slice(2);
+const option = (name, fallback) => {
+    const index = args.indexOf(name);
+    return index >= 0 ? args[index + 1] : fallback;
+};
+
+const REQUEST_COUNT = parseInt(args[0], 10) || 500;
+const WARMUP = 5;
+const MODES = ['bearer', 'hmac'];
+
+async function authStats(device) {
+    const response = await deviceClient.request(device, 'GET', '/api/auth');
+    if (response.status !== 200) {
+        throw new Error(`인증 통계 조회 실패 (HTTP ${response.status}), 관리자 권한 키가 필요합니다`);
+    }
+    return response.data.stats;
+}
+
+async function measure(device, mode) {
+    const target = { ...device, auth_mode: mode };
+    for (let i = 0; i < WARMUP; i++) {
+        await deviceClient.getStatus(target);
+    }
+
+    const before = (await authStats(target))[mode];
+    const rtts = [];
+    for (let i = 0; i < REQUEST_COUNT; i++) {
+        const startedAt = process.hrtime.bigint();
+        await deviceClient.getStatus(target);
+        rtts.push(Number(process.hrtime.bigint() - startedAt) / 1e6);
+    }
+    const after = (await authStats(target))[mode];
+
+    // 검증은 핸들러보다 먼저 끝나므로 두 번째 통계 조회 요청도 after에 포함됨
+    const count = after.count - before.count;
+    const totalUs = after.mean_us * after.count - before.mean_us * before.count;
+    return {
+        mode,
+        requests: REQUEST_COUNT,
+        failed: after.failed - before.failed,
+        rtt_ms: summarize(rtts),
+        device_auth_us: {
+            mean: count > 0 ? Math.round((totalUs / count) * 100) / 100 : null,
+            max_since_boot: after.max_us
+        }
+    };
+}
+
+function measureSigning(device) {
+    const target = { ...device, auth_mode: 'hmac' };
+    const startedAt = process.hrtime.bigint();
+    for (let i = 0; i < REQUEST_COUNT; i++) {
+        deviceClient.headers(target, 'GET', '/api/status');
+    }
+    return Math.round((Number(process.hrtime.bigint() - startedAt) / 1000 / REQUEST_COUNT) * 100) / 100;
+}
+
+async function run() {
+    const apiKey = option('--key', process.env.DEFAULT_ESP32_API_KEY || 'aircon_control_2024');
+    const apiKeyId = option('--key-id', process.env.DEVICE_API_KEY_ID || 'default');
+    let simulators = [];
+    let device;
+
+    if (option('--device')) {
+        device = {
+            id: 1,
+            ip_address: option('--device'),
+            port: parseInt(option('--port', 80), 10),
+            api_key: apiKey,
+            api_key_id: apiKeyId
+        };
+    } else {
+        simulators = await startDevices(1, { apiKey, apiKeyId });
+        device = { id: 1, ip_address: '127.0.0.1', port: simulators[0].port, api_key: apiKey, api_key_id: apiKeyId };
+    }
+
+    const results = [];
+    for (const mode of MODES) {
+        results.push(await measure(device, mode));
+    }
+
+    console.log(JSON.stringify({
+        benchmark: 'auth',
+        target: simulators.length ? 'simulator' : `${device.ip_address}`,
+        sign_us: measureSigning(device),
+        results
+    }, null, 2));
+
+    await Promise.all(simulators.map((simulator) => simulator.stop()));
+    deviceClient.agent.destroy();
+}
+
+run().catch((error) => {
+    console.error(error);
+    process.exit(1);
+});
@@ -0,0 +1,98 @@
+// 백업이 명령 처리 지연에 주는 영향 벤치마크
+// 사용법: node bench/backup.js [제어 히스토리 행 수] [--pages 64] [--delay 5]
+// 임시 DB에 제어 히스토리를 채운 뒤, 명령 결과 기록(insertControlHistoryBatch) 지연을
+// 백업이 없을 때와 백업이 진행되는 동안 각각 측정하고 백업 지표(소요 시간, 크기, 단계 수)를 함께 출력한다.
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+
+const args = process.argv.slice(2);
+const option = (name, fallback) => {
+    const index = args.indexOf(name);
+    return index >= 0 ? args[index + 1] : fallback;
+};
+
+const WORK_DIR = fs.mkdtempSync(path.join(os.tmpdir(), 'aircon-bench-backup-'));
+process.env.BACKUP_DIR = path.join(WORK_DIR, 'backups');
+process.env.BACKUP_PAGES_PER_STEP = option('--pages', '64');
+process.env.BACKUP_STEP_DELAY_MS = option('--delay', '5');
+
+const database = require('../src/utils/database');
+const backupService = require('../src/utils/backupService');
+const { summarize } = require('../src/utils/stats');
+
+const ROW_COUNT = parseInt(args[0], 10) || 200000;
+const FILL_BATCH = 500;
+const IDLE_SAMPLES = 200;
+const WRITE_INTERVAL_MS = 10;
+
+const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+
+function historyRows(count) {
+    return Array.from({ length: count }, (_, index) => ({
+        device_id: (index % 32) + 1,
+        command: 'temp',
+        parameters: JSON.stringify({ temperature: 18 + (index % 10) }),
+        user_id: 1,
+        request_id: `bench-${index}`
+    }));
+}
+
+// 그룹 명령 결과 한 건(디바이스 8대)을 기록하는 데 걸린 시간
+async function timedWrite() {
+    const startedAt = process.hrtime.bigint();
+    await database.insertControlHistoryBatch(historyRows(8));
+    return Number(process.hrtime.bigint() - startedAt) / 1e6;
+}
+
+async function measureWhile(isRunning) {
+    const latencies = [];
+    while (isRunning()) {
+        latencies.push(await timedWrite());
+        await sleep(WRITE_INTERVAL_MS);
+    }
+    return latencies;
+}
+
+async function run() {
+    database.dbPath = path.join(WORK_DIR, 'aircon_control.db');
+    await database.initialize();
+
+    for (let i = 0; i < ROW_COUNT; i += FILL_BATCH) {
+        await database.insertControlHistoryBatch(historyRows(Math.min(FILL_BATCH, ROW_COUNT - i)));
+    }
+
+    const idle = [];
+    for (let i = 0; i < IDLE_SAMPLES; i++) {
+        idle.push(await timedWrite());
+        await sleep(WRITE_INTERVAL_MS);
+    }
+
+    let running = true;
+    const backup = backupService.run('bench').finally(() => {
+        running = false;
+    });
+    const [during, metrics] = await Promise.all([measureWhile(() => running), backup]);
+
+    console.log(JSON.stringify({
+        benchmark: 'backup',
+        rows: ROW_COUNT,
+        pages_per_step: Number(process.env.BACKUP_PAGES_PER_STEP),
+        step_delay_ms: Number(process.env.BACKUP_STEP_DELAY_MS),
+        backup: metrics,
+        write_latency_ms: {
+            idle: summarize(idle),
+            during_backup: summarize(during)
+        }
+    }, null, 2));
+}
+
+run()
+    .catch((error) => {
+        console.error(error);
+        process.exitCode = 1;
+    })
+    .finally(async () => {
+        await database.close().catch(() => {});
+        fs.rmSync(WORK_DIR, { recursive: true, force: true });
+    });
@@ -0,0 +1,131 @@
+// 단일 프로세스 vs 클러스터 모드 처리량 벤치마크
+// 사용법: node bench/cluster.js [--workers 4] [--devices 32] [--concurrency 64] [--duration 20] [--airtime 0] [--port 3100]
+// 모드마다 서버(src/app.js, src/cluster.js)를 띄우고 tools/load-test.js를 같은 설정으로 실행해
+// 처리량과 지연을 비교한다. IR 전송 시간을 0으로 두면 서버 CPU가 병목이 되는 조건을 측정한다.
+// 서버와 부하 테스트가 같은 DB 파일을 사용하므로 운영 중인 서버와 같은 머신에서 실행하지 않는다.
+const { spawn } = require('child_process');
+const fs = require('fs');
+const http = require('http');
+const os = require('os');
+const path = require('path');
+
+const args = process.argv.slice(2);
+const option = (name, fallback) => {
+    const index = args.indexOf(name);
+    return index >= 0 ? args[index + 1] : fallback;
+};
+
+const ROOT = path.join(__dirname, '..');
+const PORT = parseInt(option('--port', 3100), 10);
+const WORKERS = option('--workers', String(os.availableParallelism ? os.availableParallelism() : os.cpus().length));
+const READY_TIMEOUT_MS = 30000;
+const MODES = [
+    { mode: 'single', entry: 'src/app.js', workers: 1 },
+    { mode: 'cluster', entry: 'src/cluster.js', workers: Number(WORKERS) }
+];
+
+const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+
+function isReady() {
+    return new Promise((resolve) => {
+        const req = http.get({ host: '127.0.0.1', port: PORT, path: '/api/traces/latency?hours=0' }, (res) => {
+            res.resume();
+            resolve(res.statusCode < 500);
+        });
+        req.on('error', () => resolve(false));
+    });
+}
+
+async function startServer(entry) {
+    const server = spawn(process.execPath, [entry], {
+        cwd: ROOT,
+        stdio: 'ignore',
+        env: {
+            ...process.env,
+            PORT: String(PORT),
+            CLUSTER_WORKERS: WORKERS,
+            RATE_LIMIT_MAX: '1000000000',
+            LOG_LEVEL: 'warn'
+        }
+    });
+
+    const deadline = Date.now() + READY_TIMEOUT_MS;
+    while (Date.now() < deadline) {
+        if (server.exitCode !== null) {
+            throw new Error(`${entry} 시작 실패 (exit ${server.exitCode})`);
+        }
+        if (await isReady()) {
+            return server;
+        }
+        await sleep(200);
+    }
+    server.kill('SIGKILL');
+    throw new Error(`${entry} 시작 시간 초과`);
+}
+
+function stopServer(server) {
+    return new Promise((resolve) => {
+        if (server.exitCode !== null) {
+            return resolve();
+        }
+        server.once('exit', resolve);
+        server.kill('SIGTERM');
+    });
+}
+
+function runLoadTest(out) {
+    const loadArgs = [
+        'tools/load-test.js',
+        '--server', `http://127.0.0.1:${PORT}`,
+        '--devices', option('--devices', '32'),
+        '--concurrency', option('--concurrency', '64'),
+        '--duration', option('--duration', '20'),
+        '--airtime', option('--airtime', '0'),
+        '--latency', '0',
+        '--jitter', '0',
+        '--out', out
+    ];
+
+    return new Promise((resolve, reject) => {
+        const child = spawn(process.execPath, loadArgs, { cwd: ROOT, stdio: 'ignore' });
+        child.on('exit', (code) => (code === 0
+            ? resolve(JSON.parse(fs.readFileSync(out, 'utf8')))
+            : reject(new Error(`load-test 실패 (exit ${code})`))));
+    });
+}
+
+async function run() {
+    const results = [];
+
+    for (const { mode, entry, workers } of MODES) {
+        const out = path.join(os.tmpdir(), `aircon-bench-cluster-${mode}-${process.pid}.json`);
+        const server = await startServer(entry);
+        try {
+            const report = await runLoadTest(out);
+            results.push({
+                mode,
+                workers,
+                requests: report.requests,
+                error_rate: report.error_rate,
+                throughput_rps: report.throughput_rps,
+                latency_ms: report.latency_ms
+            });
+        } finally {
+            await stopServer(server);
+            fs.rmSync(out, { force: true });
+        }
+    }
+
+    const [single, clustered] = results;
+    console.log(JSON.stringify({
+        benchmark: 'cluster',
+        cpus: os.cpus().length,
+        results,
+        speedup: single.throughput_rps ? Math.round((clustered.throughput_rps / single.throughput_rps) * 100) / 100 : null
+    }, null, 2));
+}
+
+run().catch((error) => {
+    console.error(error);
+    process.exit(1);
+});
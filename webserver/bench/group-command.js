@@ -0,0 +1,60 @@
+// 그룹 명령 팬아웃 부하 벤치마크
+// 사용법: node bench/group-command.js [디바이스 수] [IR 전송 시간(ms)]
+// 디바이스 시뮬레이터(tools/device-simulator.js)를 띄우고 동시성별 전체 소요 시간을 측정한다.
+const deviceClient = require('../src/utils/deviceClient');
+const { forEachBounded } = require('../src/utils/concurrency');
+const { startDevices } = require('../tools/device-simulator');
+
+const DEVICE_COUNT = parseInt(process.argv[2], 10) || 32;
+const IR_AIRTIME_MS = parseInt(process.argv[3], 10) || 500;
+const CONCURRENCY_LEVELS = [1, 4, 8, 16, 32];
+const API_KEY = 'aircon_control_2024';
+
+async function run() {
+    const simulators = await startDevices(DEVICE_COUNT, { apiKey: API_KEY, airtimeMs: IR_AIRTIME_MS });
+
+    const devices = simulators.map((simulator, index) => ({
+        id: index + 1,
+        ip_address: '127.0.0.1',
+        port: simulator.port,
+        api_key: API_KEY
+    }));
+    const command = deviceClient.normalizeCommand({ power: 'on' });
+
+    const results = [];
+    for (const concurrency of CONCURRENCY_LEVELS) {
+        const latencies = [];
+        const startedAt = process.hrtime.bigint();
+
+        const outcomes = await forEachBounded(
+            devices,
+            concurrency,
+            (device) => deviceClient.sendCommand(device, command),
+            (result) => latencies.push(result.duration_ms)
+        );
+
+        const wallMs = Number(process.hrtime.bigint() - startedAt) / 1e6;
+        latencies.sort((a, b) => a - b);
+        results.push({
+            concurrency,
+            devices: DEVICE_COUNT,
+            wall_ms: Math.round(wallMs),
+            first_result_ms: Math.round(latencies[0]),
+            failed: outcomes.filter((outcome) => !outcome.ok).length
+        });
+    }
+
+    console.log(JSON.stringify({
+        benchmark: 'group-command',
+        ir_airtime_ms: IR_AIRTIME_MS,
+        results
+    }, null, 2));
+
+    await Promise.all(simulators.map((simulator) => simulator.stop()));
+    deviceClient.agent.destroy();
+}
+
+run().catch((error) => {
+    console.error(error);
+    process.exit(1);
+});
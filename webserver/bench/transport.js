@@ -0,0 +1,112 @@
+// REST vs UDP 명령 채널 비교 벤치마크
+// 사용법: node bench/transport.js [명령 수] [--airtime 0]
+//         node bench/transport.js [명령 수] --device 192.168.1.100 [--port 80] [--udp-port 4210] [--key <API 키>]
+// --device가 없으면 시뮬레이터 한 대를 띄워 측정한다 (IR 전송 시간 기본 0 → 프로토콜 오버헤드만 비교).
+// 명령은 온도 up/down을 번갈아 순차 전송하며 전송 방식별로 다음을 보고한다.
+// - rtt_ms: 서버에서 측정한 왕복 시간 (REST는 keep-alive 연결 재사용 기준이므로 TCP 핸드셰이크 제외)
+// - device_parse_us: 펌웨어가 요청을 받은 뒤 IR 전송을 시작하기까지의 시간 (trace received → dispatched)
+//   REST는 핸들러 진입 이후(본문 수신, cJSON 파싱)만 포함하며 httpd의 헤더 파싱과 응답 cJSON_Print는 빠져 있음
+//   UDP는 수신 직후부터 HMAC 검증과 세션 확인까지 포함
+// - device_handler_us: 디바이스 안에서의 전체 처리 시간 (received → completed, IR 전송 포함)
+const deviceClient = require('../src/utils/deviceClient');
+const udpClient = require('../src/utils/udpClient');
+const { summarize } = require('../src/utils/stats');
+const { startDevices } = require('../tools/device-simulator');
+
+const args = process.argv.slice(2);
+const option = (name, fallback) => {
+    const index = args.indexOf(name);
+    return index >= 0 ? args[index + 1] : fallback;
+};
+
+const COMMAND_COUNT = parseInt(args[0], 10) || 200;
+const WARMUP = 5;
+const TRANSPORTS = ['http', 'udp'];
+
+function microsBetween(trace, from, to) {
+    return trace && trace[from] && trace[to] && trace[to] >= trace[from] ? trace[to] - trace[from] : null;
+}
+
+async function measure(device, transport) {
+    const target = { ...device, transport };
+    const samples = [];
+    let failed = 0;
+    let retransmits = 0;
+
+    for (let i = 0; i < WARMUP + COMMAND_COUNT; i++) {
+        const command = deviceClient.normalizeCommand({ action: i % 2 === 0 ? 'up' : 'down' });
+        const result = await deviceClient.sendCommand(target, command);
+        if (i < WARMUP) {
+            continue;
+        }
+
+        if (!result.ok) {
+            failed++;
+            continue;
+        }
+        retransmits += result.attempts ? result.attempts - 1 : 0;
+
+        const trace = result.response && result.response.trace;
+        samples.push({
+            rtt: result.duration_ms,
+            parse: microsBetween(trace, 'received_us', 'dispatched_us'),
+            handler: microsBetween(trace, 'received_us', 'completed_us')
+        });
+    }
+
+    return {
+        transport,
+        commands: COMMAND_COUNT,
+        failed,
+        retransmits,
+        rtt_ms: summarize(samples.map((sample) => sample.rtt)),
+        device_parse_us: summarize(samples.map((sample) => sample.parse)),
+        device_handler_us: summarize(samples.map((sample) => sample.handler))
+    };
+}
+
+async function run() {
+    const apiKey = option('--key', process.env.DEFAULT_ESP32_API_KEY || 'aircon_control_2024');
+    let simulators = [];
+    let device;
+
+    if (option('--device')) {
+        device = {
+            id: 1,
+            ip_address: option('--device'),
+            port: parseInt(option('--port', 80), 10),
+            udp_port: parseInt(option('--udp-port', 4210), 10),
+            api_key: apiKey
+        };
+    } else {
+        simulators = await startDevices(1, { apiKey, airtimeMs: parseInt(option('--airtime', 0), 10) });
+        device = {
+            id: 1,
+            ip_address: '127.0.0.1',
+            port: simulators[0].port,
+            udp_port: simulators[0].port,
+            api_key: apiKey
+        };
+    }
+
+    const results = [];
+    for (const transport of TRANSPORTS) {
+        results.push(await measure(device, transport));
+    }
+
+    console.log(JSON.stringify({
+        benchmark: 'transport',
+        target: simulators.length ? 'simulator' : `${device.ip_address}`,
+        results,
+        ...(simulators.length ? { simulator: simulators[0].stats } : {})
+    }, null, 2));
+
+    await Promise.all(simulators.map((simulator) => simulator.stop()));
+    deviceClient.agent.destroy();
+    udpClient.close();
+}
+
+run().catch((error) => {
+    console.error(error);
+    process.exit(1);
+});
@@ -7,11 +7,24 @@ require('dotenv').config();
 
 const logger = require('./utils/logger');
 const database = require('./utils/database');
+const ipc = require('./utils/ipc');
+const eventHub = require('./utils/eventHub');
+const deviceWatcher = require('./utils/deviceWatcher');
+const tracing = require('./utils/tracing');
+const backupService = require('./utils/backupService');
+const firmwareUpdater = require('./utils/firmwareUpdater');
+const SharedRateLimitStore = require('./utils/rateLimitStore');
+const { requireLogin } = require('./middleware/auth');
 
 // 라우터 임포트
 const authRoutes = require('./routes/auth');
 const deviceRoutes = require('./routes/device');
 const settingsRoutes = require('./routes/settings');
+const groupRoutes = require('./routes/groups');
+const firmwareRoutes = require('./routes/firmware');
+const deviceStateRoutes = require('./routes/deviceState');
+const traceRoutes = require('./routes/traces');
+const backupRoutes = require('./routes/backups');
 
 const app = express();
 const PORT = process.env.PORT || 3000;
@@ -26,9 +39,12 @@ app.use(cors({
 }));
 
 // Rate limiting
+// 부하 테스트(tools/load-test.js) 시에는 RATE_LIMIT_MAX를 올려서 실행
+// 카운터는 sharedStore에 보관 (클러스터 모드에서 워커들이 같은 한도를 공유)
 const limiter = rateLimit({
-    windowMs: 15 * 60 * 1000, // 15분
-    max: 100, // IP당 최대 100개 요청
+    windowMs: parseInt(process.env.RATE_LIMIT_WINDOW_MS, 10) || 15 * 60 * 1000, // 15분
+    max: parseInt(process.env.RATE_LIMIT_MAX, 10) || 100, // IP당 최대 100개 요청
+    store: new SharedRateLimitStore(),
     message: {
         error: '너무 많은 요청이 발생했습니다. 잠시 후 다시 시도해주세요.'
     }
@@ -42,9 +58,12 @@ app.use(express.urlencoded({ extended: true }));
 // 정적 파일 서빙
 app.use(express.static(path.join(__dirname, '../public')));
 
+// 요청 추적 ID (X-Request-ID) 부여, 디바이스 요청과 제어 히스토리까지 전달
+app.use(tracing.middleware);
+
 // 로깅 미들웨어
 app.use((req, res, next) => {
-    logger.info(`${req.method} ${req.url} - ${req.ip}`);
+    logger.info(`${req.method} ${req.url} - ${req.ip} [${req.requestId}]`);
     next();
 });
 
@@ -52,6 +71,51 @@ app.use((req, res, next) => {
 app.use('/api/auth', authRoutes);
 app.use('/api/device', deviceRoutes);
 app.use('/api/settings', settingsRoutes);
+app.use('/api/groups', requireLogin, groupRoutes);
+app.use('/api/firmware', requireLogin, firmwareRoutes);
+app.use('/api/devices', deviceStateRoutes);
+app.use('/api/traces', traceRoutes);
+app.use('/api/backups', requireLogin, backupRoutes);
+
+// 실시간 이벤트 스트림 (SSE): 디바이스 상태 변화, 명령 완료, 연결 테스트 결과
+// ?devices=1,2 로 구독할 디바이스 지정 (기본값: 전체)
+app.get('/api/events', async (req, res, next) => {
+    try {
+        // 등록된 디바이스만 구독 (없는 ID로 상태 조회 루프가 생기지 않도록)
+        const known = (await database.all('SELECT id FROM devices')).map((row) => row.id);
+        let deviceIds = known;
+        if (req.query.devices) {
+            const requested = new Set(String(req.query.devices).split(',').map((id) => Number(id)));
+            deviceIds = known.filter((id) => requested.has(id));
+            if (deviceIds.length === 0) {
+                return res.status(400).json({ error: '구독할 디바이스를 찾을 수 없습니다.' });
+            }
+        }
+
+        const client = eventHub.addClient(res, deviceIds);
+        // 클러스터 워커에서는 구독이 IPC 왕복이므로 도중에 끊긴 경우 구독한 것만 해제
+        const subscribed = [];
+        let closed = false;
+        req.on('close', () => {
+            closed = true;
+            eventHub.removeClient(client);
+            subscribed.forEach((deviceId) => deviceWatcher.unsubscribe(deviceId));
+        });
+
+        for (const deviceId of deviceIds) {
+            if (closed) {
+                break;
+            }
+            subscribed.push(deviceId);
+            const state = await deviceWatcher.subscribe(deviceId);
+            if (state) {
+                eventHub.sendTo(client, 'device-state', state);
+            }
+        }
+    } catch (error) {
+        next(error);
+    }
+});
 
 // 기본 라우트
 app.get('/', (req, res) => {
@@ -86,9 +150,19 @@ app.use((err, req, res, next) => {
 // 서버 시작
 async function startServer() {
     try {
-        // 데이터베이스 초기화
-        await database.initialize();
+        // 데이터베이스 초기화 (클러스터 워커는 primary가 테이블을 만든 뒤 연결만 함)
+        if (ipc.isWorker) {
+            await database.connect();
+        } else {
+            await database.initialize();
+        }
         logger.info('데이터베이스 초기화 완료');
+
+        // 재시작 전에 진행 중이던 펌웨어 배포 정리 (클러스터 워커에서는 primary가 담당하므로 무시됨)
+        await firmwareUpdater.recoverInterrupted();
+
+        // 주기적 DB 백업 (클러스터 워커에서는 primary가 담당하므로 무시됨)
+        backupService.start();
         
         // 서버 시작
         app.listen(PORT, () => {
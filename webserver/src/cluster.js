@@ -0,0 +1,76 @@
+// 클러스터 모드 진입점 (node src/cluster.js)
+// - primary: DB 초기화, 공유 상태(요청 제한 카운터, 디바이스 상태 조회)와 디바이스 통신(명령, OTA 배포), DB 백업을 담당하고 워커를 관리
+// - worker: src/app.js 로 HTTP 요청 처리, 디바이스 I/O와 공유 상태는 IPC로 primary에 위임
+// 단일 프로세스 모드(node src/app.js)는 같은 모듈을 프로세스 안에서 직접 사용
+const cluster = require('cluster');
+const os = require('os');
+require('dotenv').config();
+
+const WORKER_COUNT = parseInt(process.env.CLUSTER_WORKERS, 10) ||
+    (os.availableParallelism ? os.availableParallelism() : os.cpus().length);
+const RESTART_DELAY_MS = 1000;
+const SHUTDOWN_TIMEOUT_MS = 10000;
+
+async function startPrimary() {
+    const logger = require('./utils/logger');
+    const database = require('./utils/database');
+    const ipc = require('./utils/ipc');
+    const sharedStore = require('./utils/sharedStore');
+    const deviceCoordinator = require('./utils/deviceCoordinator');
+    const deviceWatcher = require('./utils/deviceWatcher');
+    const firmwareUpdater = require('./utils/firmwareUpdater');
+    const backupService = require('./utils/backupService');
+
+    // 테이블 생성/마이그레이션은 워커를 띄우기 전에 한 번만 수행
+    await database.initialize();
+    await firmwareUpdater.recoverInterrupted();
+
+    ipc.serve();
+    sharedStore.serve();
+    deviceCoordinator.serve();
+    deviceWatcher.serve();
+    firmwareUpdater.serve();
+    backupService.serve();
+    backupService.start();
+
+    let shuttingDown = false;
+
+    cluster.on('exit', (worker, code, signal) => {
+        if (shuttingDown) {
+            return;
+        }
+        logger.warn(`워커 ${worker.process.pid} 종료 (${signal || code}), ${RESTART_DELAY_MS}ms 후 재시작`);
+        setTimeout(() => cluster.fork(), RESTART_DELAY_MS);
+    });
+
+    for (let i = 0; i < WORKER_COUNT; i++) {
+        cluster.fork();
+    }
+    logger.info(`클러스터 모드: primary ${process.pid}, 워커 ${WORKER_COUNT}개`);
+
+    const shutdown = (signal) => {
+        if (shuttingDown) {
+            return;
+        }
+        shuttingDown = true;
+        logger.info(`${signal} 신호 수신, 워커 종료 중...`);
+
+        for (const worker of Object.values(cluster.workers)) {
+            worker.process.kill('SIGTERM');
+        }
+        setTimeout(() => process.exit(1), SHUTDOWN_TIMEOUT_MS).unref();
+        cluster.disconnect(() => database.close().finally(() => process.exit(0)));
+    };
+
+    process.on('SIGTERM', () => shutdown('SIGTERM'));
+    process.on('SIGINT', () => shutdown('SIGINT'));
+}
+
+if (cluster.isPrimary) {
+    startPrimary().catch((error) => {
+        console.error('클러스터 시작 실패:', error);
+        process.exit(1);
+    });
+} else {
+    require('./app');
+}
@@ -0,0 +1,19 @@
+const jwt = require('jsonwebtoken');
+
+// 로그인 토큰(JWT) 확인: Authorization: Bearer <토큰>, 통과하면 req.user에 토큰 내용을 담음
+// JWT_SECRET이 설정되지 않았으면 토큰을 검증할 수 없으므로 모두 거부
+function requireLogin(req, res, next) {
+    const match = /^Bearer (.+)$/.exec(req.get('Authorization') || '');
+    if (!match || !process.env.JWT_SECRET) {
+        return res.status(401).json({ error: '인증이 필요합니다.' });
+    }
+
+    try {
+        req.user = jwt.verify(match[1], process.env.JWT_SECRET);
+    } catch (error) {
+        return res.status(401).json({ error: '유효하지 않은 토큰입니다.' });
+    }
+    next();
+}
+
+module.exports = { requireLogin };
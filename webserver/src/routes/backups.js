@@ -0,0 +1,45 @@
+const express = require('express');
+const backupService = require('../utils/backupService');
+
+const router = express.Router();
+
+// 백업 파일에는 디바이스 API 키와 비밀번호 해시가 들어 있으므로 모든 경로에 로그인 토큰(JWT)이 필요하고 (app.js에서 requireLogin 적용)
+// 다운로드는 BACKUP_DOWNLOAD_ENABLED=true일 때만 허용
+const DOWNLOAD_ENABLED = process.env.BACKUP_DOWNLOAD_ENABLED === 'true';
+
+// 백업 스케줄, 최근 실행 지표(소요 시간/크기/압축률), 보관 중인 파일 목록
+// GET /api/backups
+router.get('/', async (req, res, next) => {
+    try {
+        res.json(await backupService.status());
+    } catch (error) {
+        next(error);
+    }
+});
+
+// 수동 백업 (실행 중인 백업이 있으면 그 결과를 반환)
+// POST /api/backups
+router.post('/', async (req, res, next) => {
+    try {
+        res.status(201).json(await backupService.run('manual'));
+    } catch (error) {
+        next(error);
+    }
+});
+
+// 백업 파일 다운로드 (gzip으로 압축된 SQLite DB)
+// GET /api/backups/aircon-20240101T030000Z.db.gz
+router.get('/:name', (req, res) => {
+    if (!DOWNLOAD_ENABLED) {
+        return res.status(403).json({ error: '백업 다운로드가 비활성화되어 있습니다.' });
+    }
+
+    const filePath = backupService.filePath(req.params.name);
+    if (!filePath) {
+        return res.status(404).json({ error: '백업 파일을 찾을 수 없습니다.' });
+    }
+
+    res.download(filePath);
+});
+
+module.exports = router;
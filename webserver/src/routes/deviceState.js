@@ -0,0 +1,155 @@
+const express = require('express');
+const database = require('../utils/database');
+const deviceCoordinator = require('../utils/deviceCoordinator');
+const deviceWatcher = require('../utils/deviceWatcher');
+const stateModel = require('../utils/stateModel');
+const commandPlanner = require('../utils/commandPlanner');
+const eventHub = require('../utils/eventHub');
+const tracing = require('../utils/tracing');
+const logger = require('../utils/logger');
+const { requireLogin } = require('../middleware/auth');
+
+const router = express.Router();
+
+async function findDevice(id) {
+    return database.get('SELECT * FROM devices WHERE id = ?', [id]);
+}
+
+function parseTarget(body) {
+    const target = {};
+    for (const field of ['power', 'mode', 'temperature', 'fan']) {
+        if (body[field] !== undefined) {
+            target[field] = field === 'temperature' || field === 'fan' ? Number(body[field]) : body[field];
+        }
+    }
+    return target;
+}
+
+// 추정 상태 조회 (control_history 재생 결과)
+router.get('/:id/state', async (req, res, next) => {
+    try {
+        const device = await findDevice(req.params.id);
+        if (!device) {
+            return res.status(404).json({ error: '디바이스를 찾을 수 없습니다.' });
+        }
+
+        res.json({ device_id: device.id, ...(await stateModel.get(device.id)) });
+    } catch (error) {
+        next(error);
+    }
+});
+
+// 목표 상태 적용: 현재 추정 상태와의 차이만 최소 명령 시퀀스로 계산해 한 번의 요청으로 전송
+// body: { power, mode, temperature, fan, dry_run }
+router.put('/:id/state', requireLogin, async (req, res, next) => {
+    try {
+        const device = await findDevice(req.params.id);
+        if (!device) {
+            return res.status(404).json({ error: '디바이스를 찾을 수 없습니다.' });
+        }
+
+        const target = parseTarget(req.body);
+        const invalid = commandPlanner.validateTarget(target);
+        if (invalid) {
+            return res.status(400).json({ error: invalid });
+        }
+
+        const userId = req.user ? req.user.id : null;
+        const result = await stateModel.withLock(device.id, async () => {
+            const current = (await stateModel.get(device.id)).state;
+            const planned = commandPlanner.plan(current, target);
+
+            if (req.body.dry_run || planned.presses === 0) {
+                return { status: 200, body: { device_id: device.id, current, ...planned, executed: 0 } };
+            }
+            if (planned.presses > commandPlanner.MAX_PRESSES) {
+                return { status: 400, body: { error: '명령 시퀀스가 너무 깁니다.', ...planned } };
+            }
+
+            const sent = await deviceCoordinator.sendSequence(device, planned.steps, { requestId: req.requestId });
+            const spans = tracing.spans(req.requestId, req.startedAt, sent);
+            const updated = await stateModel.record(device.id, planned.steps, sent.executed, userId, spans);
+
+            eventHub.publish('command', {
+                device_id: device.id,
+                command: 'sequence',
+                parameters: { steps: planned.steps },
+                ok: sent.ok,
+                duration_ms: sent.duration_ms
+            }, device.id);
+
+            const body = {
+                device_id: device.id,
+                ok: sent.ok,
+                steps: planned.steps,
+                presses: planned.presses,
+                executed: sent.executed,
+                ignored: planned.ignored,
+                state: updated.state,
+                duration_ms: sent.duration_ms,
+                spans
+            };
+
+            if (!sent.ok) {
+                // 응답을 받지 못한 경우 실제 전송 여부를 알 수 없으므로 sync로 교정 필요
+                logger.warn(`디바이스 ${device.id} 명령 시퀀스 실패: ${sent.error}`);
+                return {
+                    status: 502,
+                    body: { ...body, error: sent.error, uncertain: sent.http_status === null }
+                };
+            }
+            return { status: 200, body };
+        });
+
+        res.status(result.status).json(result.body);
+    } catch (error) {
+        // 앞 작업이 잠금을 오래 붙잡고 있어 실행하지 않음
+        if (error.code === 'ELOCKTIMEOUT') {
+            return res.status(409).json({ error: error.message });
+        }
+        next(error);
+    }
+});
+
+// 연결 테스트: 즉시 상태를 조회하고 결과를 이벤트 구독자에게도 알림 (connection-test 이벤트)
+router.post('/:id/test', requireLogin, async (req, res, next) => {
+    try {
+        const device = await findDevice(req.params.id);
+        if (!device) {
+            return res.status(404).json({ error: '디바이스를 찾을 수 없습니다.' });
+        }
+
+        const state = await deviceWatcher.testConnection(device.id);
+        res.status(state.online ? 200 : 502).json(state);
+    } catch (error) {
+        next(error);
+    }
+});
+
+// 추정 상태 교정 (리모컨으로 직접 조작한 경우 등, IR 전송 없음)
+// body: { power, mode, temperature, fan } 전체 필요
+router.post('/:id/state/sync', requireLogin, async (req, res, next) => {
+    try {
+        const device = await findDevice(req.params.id);
+        if (!device) {
+            return res.status(404).json({ error: '디바이스를 찾을 수 없습니다.' });
+        }
+
+        const state = parseTarget(req.body);
+        const invalid = commandPlanner.validateTarget(state);
+        if (invalid || Object.keys(state).length !== 4) {
+            return res.status(400).json({ error: invalid || 'power, mode, temperature, fan이 모두 필요합니다.' });
+        }
+
+        const userId = req.user ? req.user.id : null;
+        const updated = await stateModel.withLock(device.id, () => stateModel.sync(device.id, state, userId));
+        res.json({ device_id: device.id, ...updated });
+    } catch (error) {
+        if (error.code === 'ELOCKTIMEOUT') {
+            return res.status(409).json({ error: error.message });
+        }
+        next(error);
+    }
+});
+
+module.exports = router;
@@ -0,0 +1,218 @@
+const express = require('express');
+const crypto = require('crypto');
+const fs = require('fs');
+const path = require('path');
+const database = require('../utils/database');
+const firmwareUpdater = require('../utils/firmwareUpdater');
+const logger = require('../utils/logger');
+
+const router = express.Router();
+
+// 펌웨어 OTA 슬롯 크기 (firmware/partitions.csv 의 ota_0/ota_1)
+const MAX_IMAGE_SIZE = 0x180000;
+const ESP_IMAGE_MAGIC = 0xE9;
+const DEFAULT_ROLLOUT_CONCURRENCY = parseInt(process.env.FIRMWARE_ROLLOUT_CONCURRENCY, 10) || 2;
+
+// 이미지 업로드: application/octet-stream 본문을 디스크로 스트리밍하며 SHA-256 계산
+// POST /api/firmware/images?version=1.1.0
+router.post('/images', (req, res, next) => {
+    const version = req.query.version;
+    if (!version || typeof version !== 'string' || version.length > 50) {
+        return res.status(400).json({ error: 'version 쿼리 파라미터가 필요합니다.' });
+    }
+
+    const declaredSize = parseInt(req.get('Content-Length'), 10);
+    if (declaredSize > MAX_IMAGE_SIZE) {
+        return res.status(413).json({ error: `이미지는 ${MAX_IMAGE_SIZE} 바이트 이하여야 합니다.` });
+    }
+
+    fs.mkdirSync(firmwareUpdater.firmwareDir, { recursive: true });
+    const tempPath = path.join(firmwareUpdater.firmwareDir, `upload-${process.pid}-${Date.now()}.tmp`);
+    const output = fs.createWriteStream(tempPath);
+    const hash = crypto.createHash('sha256');
+    let size = 0;
+    let firstByte = null;
+    let failed = false;
+
+    const abort = (status, message) => {
+        if (failed) {
+            return;
+        }
+        failed = true;
+        req.unpipe(output);
+        output.destroy();
+        fs.unlink(tempPath, () => {});
+        res.status(status).json({ error: message });
+    };
+
+    req.on('data', (chunk) => {
+        if (firstByte === null) {
+            firstByte = chunk[0];
+        }
+        size += chunk.length;
+        if (size > MAX_IMAGE_SIZE) {
+            abort(413, `이미지는 ${MAX_IMAGE_SIZE} 바이트 이하여야 합니다.`);
+            return;
+        }
+        hash.update(chunk);
+    });
+    req.on('aborted', () => abort(400, '업로드가 중단되었습니다.'));
+    output.on('error', (error) => {
+        if (!failed) {
+            failed = true;
+            fs.unlink(tempPath, () => {});
+            next(error);
+        }
+    });
+
+    output.on('finish', async () => {
+        if (failed) {
+            return;
+        }
+        if (size === 0 || firstByte !== ESP_IMAGE_MAGIC) {
+            return abort(400, 'ESP32 펌웨어 이미지가 아닙니다.');
+        }
+
+        try {
+            const sha256 = hash.digest('hex');
+            const filename = `${sha256}.bin`;
+            fs.renameSync(tempPath, path.join(firmwareUpdater.firmwareDir, filename));
+
+            const existing = await database.get('SELECT * FROM firmware_images WHERE sha256 = ?', [sha256]);
+            if (existing) {
+                return res.json(existing);
+            }
+
+            const result = await database.run(
+                'INSERT INTO firmware_images (version, filename, size, sha256) VALUES (?, ?, ?, ?)',
+                [version, filename, size, sha256]
+            );
+            logger.info(`펌웨어 이미지 등록: ${version} (${size} 바이트, ${sha256})`);
+            res.status(201).json({ id: result.id, version, size, sha256 });
+        } catch (error) {
+            next(error);
+        }
+    });
+
+    req.pipe(output);
+});
+
+// 이미지 목록
+router.get('/images', async (req, res, next) => {
+    try {
+        const images = await database.all('SELECT * FROM firmware_images ORDER BY created_at DESC');
+        res.json({ images });
+    } catch (error) {
+        next(error);
+    }
+});
+
+// 단계별 배포 생성
+// body: { image_id, device_ids | group_id, stages: [1, 5], concurrency, max_failures }
+// stages는 앞 단계부터의 디바이스 수이며 남은 디바이스는 마지막 단계에 배정
+router.post('/rollouts', async (req, res, next) => {
+    try {
+        const { image_id: imageId, group_id: groupId } = req.body;
+        const image = await database.get('SELECT * FROM firmware_images WHERE id = ?', [imageId]);
+        if (!image) {
+            return res.status(404).json({ error: '펌웨어 이미지를 찾을 수 없습니다.' });
+        }
+
+        let deviceIds;
+        if (groupId) {
+            const members = await database.all(
+                'SELECT device_id FROM device_group_members WHERE group_id = ? ORDER BY device_id',
+                [groupId]
+            );
+            deviceIds = members.map((member) => member.device_id);
+        } else if (Array.isArray(req.body.device_ids)) {
+            // 등록되지 않은 디바이스가 섞이면 영원히 pending으로 남으므로 거부
+            const known = new Set((await database.all('SELECT id FROM devices')).map((row) => row.id));
+            const unknown = req.body.device_ids.filter((id) => !known.has(Number(id)));
+            if (unknown.length > 0) {
+                return res.status(400).json({ error: '등록되지 않은 디바이스가 있습니다.', unknown_device_ids: unknown });
+            }
+            deviceIds = [...new Set(req.body.device_ids.map(Number))];
+        }
+        if (!deviceIds || deviceIds.length === 0) {
+            return res.status(400).json({ error: '배포 대상 디바이스가 없습니다.' });
+        }
+
+        const stages = Array.isArray(req.body.stages) ? req.body.stages.map((n) => parseInt(n, 10)) : [1];
+        if (!stages.every((n) => Number.isInteger(n) && n > 0)) {
+            return res.status(400).json({ error: 'stages는 양의 정수 배열이어야 합니다.' });
+        }
+        const concurrency = Math.max(1, parseInt(req.body.concurrency, 10) || DEFAULT_ROLLOUT_CONCURRENCY);
+        const maxFailures = Math.max(0, parseInt(req.body.max_failures, 10) || 0);
+
+        const result = await database.run(
+            'INSERT INTO firmware_rollouts (image_id, concurrency, max_failures) VALUES (?, ?, ?)',
+            [image.id, concurrency, maxFailures]
+        );
+        const rolloutId = result.id;
+
+        let index = 0;
+        for (let stage = 0; index < deviceIds.length; stage++) {
+            const count = stage < stages.length ? stages[stage] : deviceIds.length - index;
+            for (const deviceId of deviceIds.slice(index, index + count)) {
+                await database.run(
+                    'INSERT INTO firmware_rollout_devices (rollout_id, device_id, stage) VALUES (?, ?, ?)',
+                    [rolloutId, deviceId, stage]
+                );
+            }
+            index += count;
+        }
+
+        // 배포는 백그라운드에서 진행하고 진행 상황은 /api/events 와 조회 API로 확인
+        firmwareUpdater.runRollout(rolloutId).catch((error) => {
+            logger.error(`펌웨어 배포 ${rolloutId} 실패:`, error);
+            database.run(
+                "UPDATE firmware_rollouts SET status = 'failed', finished_at = CURRENT_TIMESTAMP WHERE id = ?",
+                [rolloutId]
+            ).catch(() => {});
+        });
+
+        res.status(202).json({ id: rolloutId, image_id: image.id, devices: deviceIds.length });
+    } catch (error) {
+        next(error);
+    }
+});
+
+// 배포 목록
+router.get('/rollouts', async (req, res, next) => {
+    try {
+        const rollouts = await database.all(
+            `SELECT r.*, i.version FROM firmware_rollouts r
+             JOIN firmware_images i ON i.id = r.image_id
+             ORDER BY r.created_at DESC`
+        );
+        res.json({ rollouts });
+    } catch (error) {
+        next(error);
+    }
+});
+
+// 배포 상세 (디바이스별 진행 상태)
+router.get('/rollouts/:id', async (req, res, next) => {
+    try {
+        const rollout = await database.get(
+            `SELECT r.*, i.version, i.sha256, i.size FROM firmware_rollouts r
+             JOIN firmware_images i ON i.id = r.image_id
+             WHERE r.id = ?`,
+            [req.params.id]
+        );
+        if (!rollout) {
+            return res.status(404).json({ error: '배포를 찾을 수 없습니다.' });
+        }
+
+        rollout.devices = await database.all(
+            'SELECT * FROM firmware_rollout_devices WHERE rollout_id = ? ORDER BY stage, device_id',
+            [rollout.id]
+        );
+        res.json(rollout);
+    } catch (error) {
+        next(error);
+    }
+});
+
+module.exports = router;
@@ -0,0 +1,278 @@
+const express = require('express');
+const database = require('../utils/database');
+const deviceClient = require('../utils/deviceClient');
+const deviceCoordinator = require('../utils/deviceCoordinator');
+const stateModel = require('../utils/stateModel');
+const { forEachBounded } = require('../utils/concurrency');
+const eventHub = require('../utils/eventHub');
+const tracing = require('../utils/tracing');
+const logger = require('../utils/logger');
+
+const router = express.Router();
+
+// 그룹 명령 동시 실행 수
+const DEFAULT_CONCURRENCY = parseInt(process.env.GROUP_COMMAND_CONCURRENCY, 10) || 8;
+const MAX_CONCURRENCY = 32;
+
+function parseDeviceIds(value) {
+    if (!Array.isArray(value)) {
+        return null;
+    }
+    const ids = value.map((id) => parseInt(id, 10));
+    return ids.every((id) => Number.isInteger(id) && id > 0) ? [...new Set(ids)] : null;
+}
+
+// 등록되지 않은 디바이스 ID 목록
+async function findUnknownDevices(deviceIds) {
+    const known = new Set((await database.all('SELECT id FROM devices')).map((row) => row.id));
+    return deviceIds.filter((id) => !known.has(id));
+}
+
+// 트랜잭션 안에서 호출 (database.execute 사용)
+async function replaceMembers(groupId, deviceIds) {
+    await database.execute('DELETE FROM device_group_members WHERE group_id = ?', [groupId]);
+    for (const deviceId of deviceIds) {
+        await database.execute(
+            'INSERT OR IGNORE INTO device_group_members (group_id, device_id) VALUES (?, ?)',
+            [groupId, deviceId]
+        );
+    }
+}
+
+// 그룹 목록 조회
+router.get('/', async (req, res, next) => {
+    try {
+        const groups = await database.all(
+            `SELECT g.id, g.name, g.description, g.created_at, COUNT(m.device_id) AS device_count
+             FROM device_groups g
+             LEFT JOIN device_group_members m ON m.group_id = g.id
+             GROUP BY g.id
+             ORDER BY g.name`
+        );
+        res.json({ groups });
+    } catch (error) {
+        next(error);
+    }
+});
+
+// 그룹 상세 조회
+router.get('/:id', async (req, res, next) => {
+    try {
+        const group = await database.get('SELECT * FROM device_groups WHERE id = ?', [req.params.id]);
+        if (!group) {
+            return res.status(404).json({ error: '그룹을 찾을 수 없습니다.' });
+        }
+
+        group.devices = await database.all(
+            `SELECT d.id, d.name, d.ip_address, d.port, d.status, d.last_seen
+             FROM devices d
+             JOIN device_group_members m ON m.device_id = d.id
+             WHERE m.group_id = ?
+             ORDER BY d.id`,
+            [group.id]
+        );
+        res.json(group);
+    } catch (error) {
+        next(error);
+    }
+});
+
+// 그룹 생성
+router.post('/', async (req, res, next) => {
+    try {
+        const { name, description } = req.body;
+        const deviceIds = parseDeviceIds(req.body.device_ids || []);
+
+        if (!name || typeof name !== 'string') {
+            return res.status(400).json({ error: '그룹 이름이 필요합니다.' });
+        }
+        if (!deviceIds) {
+            return res.status(400).json({ error: 'device_ids는 디바이스 ID 배열이어야 합니다.' });
+        }
+        const unknown = await findUnknownDevices(deviceIds);
+        if (unknown.length > 0) {
+            return res.status(400).json({ error: '등록되지 않은 디바이스가 있습니다.', unknown_device_ids: unknown });
+        }
+
+        // 그룹과 멤버를 함께 기록 (중간에 실패하면 멤버 없는 그룹이 남지 않도록)
+        const result = await database.immediateTransaction(async () => {
+            const inserted = await database.execute(
+                'INSERT INTO device_groups (name, description) VALUES (?, ?)',
+                [name, description || null]
+            );
+            await replaceMembers(inserted.id, deviceIds);
+            return inserted;
+        });
+
+        logger.info(`디바이스 그룹 생성: ${name} (${deviceIds.length}대)`);
+        res.status(201).json({ id: result.id, name, description: description || null, device_ids: deviceIds });
+    } catch (error) {
+        if (error.code === 'SQLITE_CONSTRAINT') {
+            return res.status(409).json({ error: '같은 이름의 그룹이 이미 존재합니다.' });
+        }
+        next(error);
+    }
+});
+
+// 그룹 멤버 변경
+router.put('/:id/members', async (req, res, next) => {
+    try {
+        const deviceIds = parseDeviceIds(req.body.device_ids);
+        if (!deviceIds) {
+            return res.status(400).json({ error: 'device_ids는 디바이스 ID 배열이어야 합니다.' });
+        }
+
+        const group = await database.get('SELECT id FROM device_groups WHERE id = ?', [req.params.id]);
+        if (!group) {
+            return res.status(404).json({ error: '그룹을 찾을 수 없습니다.' });
+        }
+
+        const unknown = await findUnknownDevices(deviceIds);
+        if (unknown.length > 0) {
+            return res.status(400).json({ error: '등록되지 않은 디바이스가 있습니다.', unknown_device_ids: unknown });
+        }
+
+        // 삭제와 다시 추가 사이에 실패하면 멤버가 비지 않도록 한 트랜잭션으로
+        await database.immediateTransaction(() => replaceMembers(group.id, deviceIds));
+        res.json({ id: group.id, device_ids: deviceIds });
+    } catch (error) {
+        next(error);
+    }
+});
+
+// 그룹 삭제
+router.delete('/:id', async (req, res, next) => {
+    try {
+        const result = await database.immediateTransaction(async () => {
+            const deleted = await database.execute('DELETE FROM device_groups WHERE id = ?', [req.params.id]);
+            await database.execute('DELETE FROM device_group_members WHERE group_id = ?', [req.params.id]);
+            return deleted;
+        });
+        if (result.changes === 0) {
+            return res.status(404).json({ error: '그룹을 찾을 수 없습니다.' });
+        }
+
+        res.json({ message: '그룹이 삭제되었습니다.' });
+    } catch (error) {
+        next(error);
+    }
+});
+
+// 그룹 명령: 제한된 동시성으로 팬아웃하고 디바이스별 결과를 완료 순서대로 스트리밍
+// Accept: text/event-stream 이면 SSE, 그 외에는 줄 단위 JSON(application/x-ndjson)
+router.post('/:id/command', async (req, res, next) => {
+    let send = null;
+
+    try {
+        const command = deviceClient.normalizeCommand(req.body);
+        if (!command) {
+            return res.status(400).json({ error: '잘못된 제어 명령입니다.' });
+        }
+
+        const group = await database.get('SELECT * FROM device_groups WHERE id = ?', [req.params.id]);
+        if (!group) {
+            return res.status(404).json({ error: '그룹을 찾을 수 없습니다.' });
+        }
+
+        const devices = await database.all(
+            `SELECT d.* FROM devices d
+             JOIN device_group_members m ON m.device_id = d.id
+             WHERE m.group_id = ?
+             ORDER BY d.id`,
+            [group.id]
+        );
+
+        const requested = parseInt(req.body.concurrency, 10) || DEFAULT_CONCURRENCY;
+        const concurrency = Math.max(1, Math.min(requested, MAX_CONCURRENCY));
+        const userId = req.user ? req.user.id : null;
+
+        const useSse = (req.get('Accept') || '').includes('text/event-stream');
+        res.status(200);
+        res.set({
+            'Content-Type': useSse ? 'text/event-stream; charset=utf-8' : 'application/x-ndjson; charset=utf-8',
+            'Cache-Control': 'no-cache',
+            'X-Accel-Buffering': 'no'
+        });
+        res.flushHeaders();
+
+        send = (event, data) => {
+            if (res.writableEnded || res.destroyed) {
+                return;
+            }
+            if (useSse) {
+                res.write(`event: ${event}\ndata: ${JSON.stringify(data)}\n\n`);
+            } else {
+                res.write(JSON.stringify({ event, ...data }) + '\n');
+            }
+        };
+
+        const startedAt = Date.now();
+        send('start', {
+            group_id: group.id,
+            request_id: req.requestId,
+            command: command.command,
+            device_count: devices.length,
+            concurrency
+        });
+
+        // 클라이언트가 연결을 끊어도 이미 시작한 명령은 끝까지 수행하고 기록
+        // 전원 ON/OFF는 같은 토글 코드이므로 상태 계획(PUT /api/devices/:id/state)과 섞이지 않도록
+        // 디바이스별 상태 잠금 안에서 전송하고, 다음 계획이 이 명령을 반영하도록 잠금 안에서 기록
+        const results = await forEachBounded(
+            devices,
+            concurrency,
+            (device) => stateModel.withLock(device.id, async () => {
+                const result = await deviceCoordinator.sendCommand(device, command, { requestId: req.requestId });
+                result.spans = tracing.spans(req.requestId, req.startedAt, result);
+                await database.insertControlHistoryBatch([{
+                    device_id: device.id,
+                    command: command.command,
+                    parameters: JSON.stringify({
+                        ...command.body,
+                        group_id: group.id,
+                        ok: result.ok,
+                        ...(result.ok ? {} : { error: result.error })
+                    }),
+                    user_id: userId,
+                    ...result.spans
+                }]);
+                return result;
+            }),
+            (result, index) => {
+                const deviceId = devices[index].id;
+                send('result', { ...result, device_id: deviceId });
+                eventHub.publish('command', {
+                    device_id: deviceId,
+                    group_id: group.id,
+                    command: command.command,
+                    parameters: command.body,
+                    ok: result.ok,
+                    duration_ms: result.duration_ms
+                }, deviceId);
+            }
+        );
+
+        const succeeded = results.filter((result) => result.ok).length;
+        const summary = {
+            group_id: group.id,
+            succeeded,
+            failed: results.length - succeeded,
+            duration_ms: Date.now() - startedAt
+        };
+        logger.info(`그룹 명령 완료: ${group.name} ${command.command} (${succeeded}/${results.length}, ${summary.duration_ms}ms)`);
+
+        send('done', summary);
+        res.end();
+    } catch (error) {
+        if (!send) {
+            return next(error);
+        }
+
+        // 스트림이 이미 시작되었으므로 에러도 이벤트로 전달
+        logger.error('그룹 명령 실패:', error);
+        send('error', { error: error.message });
+        res.end();
+    }
+});
+
+module.exports = router;
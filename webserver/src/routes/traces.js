@@ -0,0 +1,74 @@
+const express = require('express');
+const database = require('../utils/database');
+const { summarize } = require('../utils/stats');
+
+const router = express.Router();
+
+const SPANS = {
+    total: 'span_total_ms',
+    server: 'span_server_ms',
+    network: 'span_network_ms',
+    parse: 'span_parse_ms',
+    first_frame: 'span_first_frame_ms',
+    repeat: 'span_repeat_ms'
+};
+const MAX_ROWS = 10000;
+const DEFAULT_HOURS = 24;
+const MAX_HOURS = 24 * 30;
+
+// 구간별 지연 분포 (p50/p95/p99/max/mean)
+// GET /api/traces/latency?device_id=1&command=temp&hours=24
+router.get('/latency', async (req, res, next) => {
+    try {
+        // 숫자가 아닐 때만 기본값 (0은 유효한 값)
+        const requested = parseFloat(req.query.hours);
+        const hours = Math.min(Math.max(Number.isFinite(requested) ? requested : DEFAULT_HOURS, 0), MAX_HOURS);
+        const conditions = ['span_total_ms IS NOT NULL', "executed_at >= datetime('now', ?)"];
+        const params = [`-${hours * 60} minutes`];
+
+        if (req.query.device_id) {
+            conditions.push('device_id = ?');
+            params.push(parseInt(req.query.device_id, 10));
+        }
+        if (req.query.command) {
+            conditions.push('command = ?');
+            params.push(req.query.command);
+        }
+
+        const rows = await database.all(
+            `SELECT ${Object.values(SPANS).join(', ')} FROM control_history
+             WHERE ${conditions.join(' AND ')}
+             ORDER BY id DESC
+             LIMIT ${MAX_ROWS}`,
+            params
+        );
+
+        const spans = {};
+        for (const [name, column] of Object.entries(SPANS)) {
+            spans[name] = summarize(rows.map((row) => row[column]));
+        }
+
+        res.json({ hours, count: rows.length, spans });
+    } catch (error) {
+        next(error);
+    }
+});
+
+// 추적 ID로 명령 기록 조회 (그룹 명령은 디바이스별 행이 모두 반환됨)
+router.get('/:requestId', async (req, res, next) => {
+    try {
+        const rows = await database.all(
+            'SELECT * FROM control_history WHERE request_id = ? ORDER BY id',
+            [req.params.requestId]
+        );
+        if (rows.length === 0) {
+            return res.status(404).json({ error: '추적 기록을 찾을 수 없습니다.' });
+        }
+
+        res.json({ request_id: req.params.requestId, commands: rows });
+    } catch (error) {
+        next(error);
+    }
+});
+
+module.exports = router;
@@ -0,0 +1,219 @@
+const fs = require('fs');
+const path = require('path');
+const zlib = require('zlib');
+const { pipeline } = require('stream/promises');
+const database = require('./database');
+const ipc = require('./ipc');
+const logger = require('./logger');
+
+const BACKUP_DIR = process.env.BACKUP_DIR || path.join(__dirname, '../../data/backups');
+const PAGES_PER_STEP = parseInt(process.env.BACKUP_PAGES_PER_STEP, 10) || 64;
+const STEP_DELAY_MS = parseInt(process.env.BACKUP_STEP_DELAY_MS, 10) || 5;
+const MAX_RESTARTS = 3;
+const HISTORY_SIZE = 20;
+const FILE_PATTERN = /^aircon-(\d{8}T\d{6}Z)\.db\.gz$/;
+const DAY_MS = 24 * 60 * 60 * 1000;
+
+// "30m", "6h", "1d" 형식 (단위 없으면 밀리초)
+function parseInterval(value) {
+    const match = /^(\d+(?:\.\d+)?)\s*(ms|s|m|h|d)?$/.exec(String(value).trim());
+    if (!match) {
+        return null;
+    }
+    const units = { ms: 1, s: 1000, m: 60 * 1000, h: 60 * 60 * 1000, d: DAY_MS };
+    return Math.round(Number(match[1]) * units[match[2] || 'ms']);
+}
+
+// 20240101T030000Z (파일 이름용 UTC 시각)
+function timestamp(date) {
+    return date.toISOString().replace(/[-:]/g, '').replace(/\.\d{3}/, '');
+}
+
+function parseTimestamp(value) {
+    const [, y, mo, d, h, mi, s] = /^(\d{4})(\d{2})(\d{2})T(\d{2})(\d{2})(\d{2})Z$/.exec(value);
+    return Date.UTC(y, mo - 1, d, h, mi, s);
+}
+
+// 주기적 DB 백업: 페이지 단위 온라인 복사 → gzip 압축 → 보관 기간이 지난 백업 삭제
+// 클러스터 모드에서는 primary만 스케줄을 돌리고 워커의 수동 실행/조회 요청은 IPC로 위임
+class BackupService {
+    constructor() {
+        this.dir = BACKUP_DIR;
+        this.enabled = process.env.BACKUP_ENABLED !== 'false';
+        this.intervalMs = parseInterval(process.env.BACKUP_INTERVAL || '24h') || DAY_MS;
+        this.retentionDays = parseFloat(process.env.BACKUP_RETENTION_DAYS) || 7;
+        this.timer = null;
+        this.nextRunAt = null;
+        this.running = null;
+        this.history = [];
+    }
+
+    start() {
+        if (!this.enabled || ipc.isWorker || this.timer) {
+            return;
+        }
+
+        fs.mkdirSync(this.dir, { recursive: true });
+        // 중간에 종료되어 남은 임시 파일 정리
+        for (const name of fs.readdirSync(this.dir)) {
+            if (name.endsWith('.tmp')) {
+                fs.rmSync(path.join(this.dir, name), { force: true });
+            }
+        }
+
+        // 재시작해도 마지막 백업 기준으로 주기 유지
+        const latest = this.listFiles()[0];
+        const delay = latest ? Math.max(0, latest.created_at.getTime() + this.intervalMs - Date.now()) : 0;
+        this.schedule(delay);
+        logger.info(`DB 백업 스케줄 시작: ${this.intervalMs / 60000}분 간격, ${this.retentionDays}일 보관`);
+    }
+
+    stop() {
+        clearTimeout(this.timer);
+        this.timer = null;
+        this.nextRunAt = null;
+    }
+
+    schedule(delay) {
+        this.nextRunAt = new Date(Date.now() + delay);
+        this.timer = setTimeout(async () => {
+            try {
+                await this.run('schedule');
+            } catch (error) {
+                // 실패 내역은 history에 남음
+            }
+            this.schedule(this.intervalMs);
+        }, delay);
+        this.timer.unref();
+    }
+
+    // 실행 중인 백업이 있으면 새로 시작하지 않고 그 결과를 공유
+    run(trigger = 'manual') {
+        if (ipc.isWorker) {
+            return ipc.request('backup:run', { trigger });
+        }
+
+        if (!this.running) {
+            this.running = this.execute(trigger).finally(() => {
+                this.running = null;
+            });
+        }
+        return this.running;
+    }
+
+    async execute(trigger) {
+        const startedAt = new Date();
+        const base = `aircon-${timestamp(startedAt)}`;
+        const name = `${base}.db.gz`;
+        const rawPath = path.join(this.dir, `${base}.db.tmp`);
+        const gzipPath = path.join(this.dir, `${name}.tmp`);
+        const record = { name, trigger, started_at: startedAt.toISOString() };
+
+        fs.mkdirSync(this.dir, { recursive: true });
+        try {
+            const copyStartedAt = Date.now();
+            try {
+                Object.assign(record, { method: 'backup-api' }, await database.backup(rawPath, {
+                    pagesPerStep: PAGES_PER_STEP,
+                    stepDelayMs: STEP_DELAY_MS,
+                    maxRestarts: MAX_RESTARTS
+                }));
+            } catch (error) {
+                if (error.code !== 'BACKUP_RESTARTED') {
+                    throw error;
+                }
+                logger.warn(`${error.message} VACUUM INTO로 다시 백업합니다.`);
+                fs.rmSync(rawPath, { force: true });
+                await database.vacuumInto(rawPath);
+                record.method = 'vacuum-into';
+            }
+            record.copy_ms = Date.now() - copyStartedAt;
+
+            const compressStartedAt = Date.now();
+            await pipeline(fs.createReadStream(rawPath), zlib.createGzip(), fs.createWriteStream(gzipPath));
+            fs.renameSync(gzipPath, path.join(this.dir, name));
+            record.compress_ms = Date.now() - compressStartedAt;
+
+            record.size_bytes = fs.statSync(rawPath).size;
+            record.compressed_bytes = fs.statSync(path.join(this.dir, name)).size;
+            // 압축 후 크기 / 원본 크기
+            record.compression_ratio = record.size_bytes > 0
+                ? Math.round((record.compressed_bytes / record.size_bytes) * 1000) / 1000
+                : null;
+            record.duration_ms = Date.now() - startedAt.getTime();
+            record.status = 'success';
+            record.rotated = this.rotate();
+
+            logger.info(`DB 백업 완료: ${name} (${record.size_bytes} → ${record.compressed_bytes} bytes, ${record.duration_ms}ms)`);
+            return record;
+        } catch (error) {
+            Object.assign(record, { status: 'failed', error: error.message, duration_ms: Date.now() - startedAt.getTime() });
+            logger.error('DB 백업 실패:', error);
+            throw error;
+        } finally {
+            fs.rmSync(rawPath, { force: true });
+            fs.rmSync(gzipPath, { force: true });
+            this.history.unshift(record);
+            this.history.length = Math.min(this.history.length, HISTORY_SIZE);
+        }
+    }
+
+    // 보관 기간이 지난 백업 삭제 (가장 최근 백업은 항상 유지)
+    rotate() {
+        const cutoff = Date.now() - this.retentionDays * DAY_MS;
+        const removed = [];
+
+        for (const file of this.listFiles().slice(1)) {
+            if (file.created_at.getTime() < cutoff) {
+                fs.rmSync(path.join(this.dir, file.name), { force: true });
+                removed.push(file.name);
+            }
+        }
+        return removed;
+    }
+
+    // 최신순
+    listFiles() {
+        if (!fs.existsSync(this.dir)) {
+            return [];
+        }
+
+        return fs.readdirSync(this.dir)
+            .map((name) => FILE_PATTERN.exec(name))
+            .filter(Boolean)
+            .map((match) => ({
+                name: match[0],
+                created_at: new Date(parseTimestamp(match[1])),
+                size_bytes: fs.statSync(path.join(this.dir, match[0])).size
+            }))
+            .sort((a, b) => b.created_at - a.created_at);
+    }
+
+    filePath(name) {
+        return FILE_PATTERN.test(name) && fs.existsSync(path.join(this.dir, name)) ? path.join(this.dir, name) : null;
+    }
+
+    async status() {
+        if (ipc.isWorker) {
+            return ipc.request('backup:status', {});
+        }
+
+        return {
+            enabled: this.enabled,
+            interval_ms: this.intervalMs,
+            retention_days: this.retentionDays,
+            running: Boolean(this.running),
+            next_run_at: this.nextRunAt ? this.nextRunAt.toISOString() : null,
+            history: this.history,
+            files: this.listFiles()
+        };
+    }
+
+    // primary: 워커 요청 처리 등록
+    serve() {
+        ipc.handle('backup:run', ({ trigger }) => this.run(trigger));
+        ipc.handle('backup:status', () => this.status());
+    }
+}
+
+module.exports = new BackupService();
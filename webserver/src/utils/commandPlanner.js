@@ -0,0 +1,142 @@
+// 현재 상태(상태 모델의 추정값)에서 목표 상태로 가는 최소 IR 명령 시퀀스 계산
+// 명령 이름은 펌웨어 POST /api/aircon/sequence 와 같음 (firmware/main/ir_controller.c 의 command_names)
+
+const TEMP_MIN = 18;
+const TEMP_MAX = 30;
+const MODES = ['cool', 'heat', 'fan'];
+const FAN_SPEEDS = [1, 2, 3];
+
+// 펌웨어 IR_SEQUENCE_MAX
+const MAX_PRESSES = 32;
+
+// 목표 상태 검증: 지정하지 않은 항목은 현재 상태 유지
+function validateTarget(target) {
+    if (!target || typeof target !== 'object') {
+        return '목표 상태가 필요합니다.';
+    }
+    if (target.power !== undefined && !['on', 'off'].includes(target.power)) {
+        return 'power는 on 또는 off여야 합니다.';
+    }
+    if (target.mode !== undefined && !MODES.includes(target.mode)) {
+        return `mode는 ${MODES.join(', ')} 중 하나여야 합니다.`;
+    }
+    if (target.temperature !== undefined &&
+        !(Number.isInteger(target.temperature) && target.temperature >= TEMP_MIN && target.temperature <= TEMP_MAX)) {
+        return `temperature는 ${TEMP_MIN}~${TEMP_MAX} 사이의 정수여야 합니다.`;
+    }
+    if (target.fan !== undefined && !FAN_SPEEDS.includes(target.fan)) {
+        return 'fan은 1, 2, 3 중 하나여야 합니다.';
+    }
+    return null;
+}
+
+// 반환: { steps: [{ command, count }], presses, state(실행 후 예상 상태), ignored: [항목] }
+// - 이미 목표 값인 항목은 보내지 않음 (기본 코드는 전원 ON/OFF가 같은 토글 코드라 중복 전송하면 꺼짐)
+// - 온도는 상대 명령(up/down)뿐이므로 차이만큼의 반복을 한 단계로 묶어 한 번의 요청으로 전송
+// - 전원이 꺼진 상태로 끝나는 경우 모드/온도/팬 변경은 실내기가 무시하므로 보내지 않음
+// - 송풍 모드에서는 설정 온도 변경을 보내지 않음
+function plan(current, target) {
+    const desired = {
+        power: target.power !== undefined ? target.power : current.power,
+        mode: target.mode !== undefined ? target.mode : current.mode,
+        temperature: target.temperature !== undefined ? target.temperature : current.temperature,
+        fan: target.fan !== undefined ? target.fan : current.fan
+    };
+
+    const steps = [];
+    const state = { ...current };
+    const ignored = [];
+
+    if (desired.power === 'off') {
+        if (current.power === 'on') {
+            steps.push({ command: 'power_off', count: 1 });
+            state.power = 'off';
+        }
+        for (const field of ['mode', 'temperature', 'fan']) {
+            if (desired[field] !== current[field]) {
+                ignored.push(field);
+            }
+        }
+        return finish(steps, state, ignored);
+    }
+
+    if (current.power !== 'on') {
+        steps.push({ command: 'power_on', count: 1 });
+        state.power = 'on';
+    }
+
+    if (desired.mode !== state.mode) {
+        steps.push({ command: `mode_${desired.mode}`, count: 1 });
+        state.mode = desired.mode;
+    }
+
+    if (desired.fan !== state.fan) {
+        steps.push({ command: `fan_${desired.fan}`, count: 1 });
+        state.fan = desired.fan;
+    }
+
+    const delta = desired.temperature - state.temperature;
+    if (delta !== 0) {
+        if (state.mode === 'fan') {
+            ignored.push('temperature');
+        } else {
+            steps.push({ command: delta > 0 ? 'temp_up' : 'temp_down', count: Math.abs(delta) });
+            state.temperature = desired.temperature;
+        }
+    }
+
+    return finish(steps, state, ignored);
+}
+
+function finish(steps, state, ignored) {
+    const presses = steps.reduce((total, step) => total + step.count, 0);
+    return { steps, presses, state, ignored };
+}
+
+// 시퀀스 중 앞에서부터 executed개 명령만 전송된 경우의 상태
+function applySteps(current, steps, executed = Infinity) {
+    const state = { ...current };
+    let remaining = executed;
+
+    for (const step of steps) {
+        const count = Math.min(step.count, remaining);
+        if (count <= 0) {
+            break;
+        }
+        applyCommand(state, step.command, count);
+        remaining -= count;
+    }
+
+    return state;
+}
+
+// 명령 하나를 상태에 반영 (상태 모델의 히스토리 재생에도 사용)
+// plan()과 같은 규칙: 전원이 꺼져 있으면 모드/온도/팬 명령은 실내기가 무시, 송풍 모드에서는 온도 명령 무시
+function applyCommand(state, command, count = 1) {
+    const [kind, value] = command.split('_');
+
+    if (kind === 'power') {
+        state.power = value;
+    } else if (state.power !== 'on') {
+        return state;
+    } else if (kind === 'mode') {
+        state.mode = value;
+    } else if (kind === 'fan') {
+        state.fan = parseInt(value, 10);
+    } else if (kind === 'temp' && state.mode !== 'fan') {
+        const step = value === 'up' ? count : -count;
+        state.temperature = Math.min(TEMP_MAX, Math.max(TEMP_MIN, state.temperature + step));
+    }
+
+    return state;
+}
+
+module.exports = {
+    TEMP_MIN,
+    TEMP_MAX,
+    MAX_PRESSES,
+    validateTarget,
+    plan,
+    applySteps,
+    applyCommand
+};
@@ -0,0 +1,49 @@
+// 최대 limit개까지만 동시에 worker를 실행하고, 완료되는 순서대로 onSettled 호출
+async function forEachBounded(items, limit, worker, onSettled) {
+    const results = new Array(items.length);
+    const poolSize = Math.max(1, Math.min(limit, items.length));
+    let next = 0;
+
+    async function runLane() {
+        while (next < items.length) {
+            const index = next++;
+            try {
+                results[index] = await worker(items[index], index);
+            } catch (error) {
+                results[index] = { ok: false, error: error.message };
+            }
+
+            if (onSettled) {
+                onSettled(results[index], index);
+            }
+        }
+    }
+
+    const lanes = [];
+    for (let i = 0; i < poolSize; i++) {
+        lanes.push(runLane());
+    }
+    await Promise.all(lanes);
+
+    return results;
+}
+
+// 키별 직렬 실행 큐: 같은 키의 task는 앞의 task가 끝난 뒤(성공/실패 무관) 실행
+function createKeyedQueue() {
+    const tails = new Map();
+
+    return function enqueue(key, task) {
+        const previous = tails.get(key) || Promise.resolve();
+        const run = previous.then(task, task);
+        const tail = run.catch(() => {});
+        tails.set(key, tail);
+        tail.then(() => {
+            if (tails.get(key) === tail) {
+                tails.delete(key);
+            }
+        });
+        return run;
+    };
+}
+
+module.exports = { forEachBounded, createKeyedQueue };
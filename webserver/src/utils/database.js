@@ -3,29 +3,43 @@ const path = require('path');
 const fs = require('fs');
 const logger = require('./logger');
 
+// 명령 추적 컬럼 (기존 DB는 migrateColumns로 추가)
+const CONTROL_HISTORY_TRACE_COLUMNS = {
+    request_id: 'VARCHAR(64)',
+    span_total_ms: 'REAL',
+    span_server_ms: 'REAL',
+    span_network_ms: 'REAL',
+    span_parse_ms: 'REAL',
+    span_first_frame_ms: 'REAL',
+    span_repeat_ms: 'REAL'
+};
+
+const BUSY_TIMEOUT_MS = 5000;
+
+// 디바이스 명령 전송 방식 ('http' | 'udp', NULL이면 DEVICE_TRANSPORT 기본값)
+const DEVICE_TRANSPORT_COLUMNS = {
+    transport: 'VARCHAR(10)',
+    udp_port: 'INTEGER'
+};
+
+// 디바이스 인증 방식 ('bearer' | 'hmac', NULL이면 DEVICE_AUTH_MODE 기본값)과 펌웨어 키 저장소의 키 ID
+const DEVICE_AUTH_COLUMNS = {
+    auth_mode: 'VARCHAR(10)',
+    api_key_id: 'VARCHAR(15)'
+};
+
 class Database {
     constructor() {
         this.dbPath = path.join(__dirname, '../../data/aircon_control.db');
         this.db = null;
+        // 진행 중인 트랜잭션 (끝나면 resolve, 없으면 null)
+        this.pendingTransaction = null;
     }
 
+    // 연결 + 테이블 생성/마이그레이션 + 기본 데이터 (단일 프로세스, 클러스터 primary)
     async initialize() {
         try {
-            // 데이터 디렉토리 생성
-            const dataDir = path.dirname(this.dbPath);
-            if (!fs.existsSync(dataDir)) {
-                fs.mkdirSync(dataDir, { recursive: true });
-                logger.info('데이터 디렉토리 생성됨:', dataDir);
-            }
-
-            // 데이터베이스 연결
-            this.db = new sqlite3.Database(this.dbPath, (err) => {
-                if (err) {
-                    logger.error('데이터베이스 연결 실패:', err);
-                    throw err;
-                }
-                logger.info('SQLite 데이터베이스 연결됨:', this.dbPath);
-            });
+            await this.connect();
 
             // 테이블 생성
             await this.createTables();
@@ -39,6 +53,31 @@ class Database {
         }
     }
 
+    // 연결만 수행 (클러스터 워커: 스키마는 워커를 띄우기 전에 primary가 준비함)
+    async connect() {
+        // 데이터 디렉토리 생성
+        const dataDir = path.dirname(this.dbPath);
+        if (!fs.existsSync(dataDir)) {
+            fs.mkdirSync(dataDir, { recursive: true });
+            logger.info('데이터 디렉토리 생성됨:', dataDir);
+        }
+
+        // 데이터베이스 연결
+        this.db = new sqlite3.Database(this.dbPath, (err) => {
+            if (err) {
+                logger.error('데이터베이스 연결 실패:', err);
+                throw err;
+            }
+            logger.info('SQLite 데이터베이스 연결됨:', this.dbPath);
+        });
+
+        // WAL: 클러스터 워커/백업 등 여러 연결이 읽는 동안에도 쓰기 가능
+        // 쓰기 잠금이 풀릴 때까지 SQLITE_BUSY 대신 최대 BUSY_TIMEOUT_MS 대기
+        this.db.configure('busyTimeout', BUSY_TIMEOUT_MS);
+        await this.run('PRAGMA journal_mode = WAL');
+        await this.run('PRAGMA synchronous = NORMAL');
+    }
+
     async createTables() {
         const tables = [
             // 사용자 테이블
@@ -79,16 +118,90 @@ class Database {
                 executed_at DATETIME DEFAULT CURRENT_TIMESTAMP,
                 FOREIGN KEY (device_id) REFERENCES devices(id),
                 FOREIGN KEY (user_id) REFERENCES users(id)
-            )`
+            )`,
+
+            // 디바이스 그룹 테이블
+            `CREATE TABLE IF NOT EXISTS device_groups (
+                id INTEGER PRIMARY KEY AUTOINCREMENT,
+                name VARCHAR(100) UNIQUE NOT NULL,
+                description TEXT,
+                created_at DATETIME DEFAULT CURRENT_TIMESTAMP
+            )`,
+
+            // 디바이스 그룹 멤버 테이블
+            `CREATE TABLE IF NOT EXISTS device_group_members (
+                group_id INTEGER NOT NULL,
+                device_id INTEGER NOT NULL,
+                PRIMARY KEY (group_id, device_id),
+                FOREIGN KEY (group_id) REFERENCES device_groups(id) ON DELETE CASCADE,
+                FOREIGN KEY (device_id) REFERENCES devices(id) ON DELETE CASCADE
+            )`,
+
+            // 펌웨어 이미지 테이블
+            `CREATE TABLE IF NOT EXISTS firmware_images (
+                id INTEGER PRIMARY KEY AUTOINCREMENT,
+                version VARCHAR(50) NOT NULL,
+                filename VARCHAR(255) NOT NULL,
+                size INTEGER NOT NULL,
+                sha256 VARCHAR(64) UNIQUE NOT NULL,
+                created_at DATETIME DEFAULT CURRENT_TIMESTAMP
+            )`,
+
+            // 펌웨어 배포 테이블
+            `CREATE TABLE IF NOT EXISTS firmware_rollouts (
+                id INTEGER PRIMARY KEY AUTOINCREMENT,
+                image_id INTEGER NOT NULL,
+                status VARCHAR(20) DEFAULT 'pending',
+                concurrency INTEGER NOT NULL,
+                max_failures INTEGER NOT NULL,
+                created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+                finished_at DATETIME,
+                FOREIGN KEY (image_id) REFERENCES firmware_images(id)
+            )`,
+
+            // 펌웨어 배포 대상 디바이스 테이블
+            `CREATE TABLE IF NOT EXISTS firmware_rollout_devices (
+                rollout_id INTEGER NOT NULL,
+                device_id INTEGER NOT NULL,
+                stage INTEGER NOT NULL,
+                status VARCHAR(20) DEFAULT 'pending',
+                bytes_sent INTEGER DEFAULT 0,
+                error TEXT,
+                updated_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+                PRIMARY KEY (rollout_id, device_id),
+                FOREIGN KEY (rollout_id) REFERENCES firmware_rollouts(id),
+                FOREIGN KEY (device_id) REFERENCES devices(id)
+            )`,
+
+            // 디바이스별 제어 히스토리 조회 인덱스 (상태 모델 재생)
+            `CREATE INDEX IF NOT EXISTS idx_control_history_device
+                ON control_history (device_id, id)`
         ];
 
         for (const table of tables) {
             await this.run(table);
         }
+
+        await this.migrateColumns('control_history', CONTROL_HISTORY_TRACE_COLUMNS);
+        await this.run('CREATE INDEX IF NOT EXISTS idx_control_history_request ON control_history (request_id)');
+        await this.migrateColumns('devices', DEVICE_TRANSPORT_COLUMNS);
+        await this.migrateColumns('devices', DEVICE_AUTH_COLUMNS);
         
         logger.info('데이터베이스 테이블 생성 완료');
     }
 
+    // 없는 컬럼만 ALTER TABLE로 추가 (SQLite는 ADD COLUMN IF NOT EXISTS 미지원)
+    async migrateColumns(table, columns) {
+        const existing = new Set((await this.all(`PRAGMA table_info(${table})`)).map((column) => column.name));
+
+        for (const [name, definition] of Object.entries(columns)) {
+            if (!existing.has(name)) {
+                await this.run(`ALTER TABLE ${table} ADD COLUMN ${name} ${definition}`);
+                logger.info(`컬럼 추가: ${table}.${name}`);
+            }
+        }
+    }
+
     async insertDefaultData() {
         try {
             // 기본 설정 삽입
@@ -120,7 +233,16 @@ class Database {
     }
 
     // 쿼리 실행 (INSERT, UPDATE, DELETE)
-    run(sql, params = []) {
+    // 트랜잭션이 열려 있으면 끝날 때까지 대기 (같은 연결이라 그대로 실행하면 남의 트랜잭션에 섞여 함께 커밋/롤백됨)
+    async run(sql, params = []) {
+        while (this.pendingTransaction) {
+            await this.pendingTransaction;
+        }
+        return this.execute(sql, params);
+    }
+
+    // 트랜잭션 대기 없이 실행 (트랜잭션 안의 쿼리용)
+    execute(sql, params = []) {
         return new Promise((resolve, reject) => {
             this.db.run(sql, params, function(err) {
                 if (err) {
@@ -161,9 +283,26 @@ class Database {
         });
     }
 
+    // 트랜잭션은 한 번에 하나만 실행 (연결이 하나라 겹치면 "cannot start a transaction within a transaction")
+    async withTransactionLock(task) {
+        while (this.pendingTransaction) {
+            await this.pendingTransaction;
+        }
+
+        const current = Promise.resolve().then(task);
+        const clear = () => {
+            if (this.pendingTransaction === settled) {
+                this.pendingTransaction = null;
+            }
+        };
+        const settled = current.then(clear, clear);
+        this.pendingTransaction = settled;
+        return current;
+    }
+
     // 트랜잭션 실행
     async transaction(callback) {
-        return new Promise((resolve, reject) => {
+        return this.withTransactionLock(() => new Promise((resolve, reject) => {
             this.db.serialize(() => {
                 this.db.run('BEGIN TRANSACTION');
                 
@@ -182,6 +321,52 @@ class Database {
                     reject(error);
                 }
             });
+        }));
+    }
+
+    // 비동기 작업을 한 트랜잭션으로 실행 (task가 던지면 롤백)
+    // task 안에서는 run 대신 execute를 사용 (run은 이 트랜잭션이 끝나기를 기다리므로 교착됨)
+    async immediateTransaction(task) {
+        return this.withTransactionLock(async () => {
+            // IMMEDIATE: 다른 프로세스와 쓰기가 겹치면 시작 시점에 busyTimeout만큼 대기 (중간 승격 실패 방지)
+            await this.execute('BEGIN IMMEDIATE');
+            try {
+                const result = await task();
+                await this.execute('COMMIT');
+                return result;
+            } catch (error) {
+                await this.execute('ROLLBACK').catch(() => {});
+                throw error;
+            }
+        });
+    }
+
+    // 제어 히스토리 일괄 기록 (명령 시퀀스 결과를 한 트랜잭션으로 저장, 추적 컬럼은 없으면 NULL)
+    async insertControlHistoryBatch(rows) {
+        if (!rows || rows.length === 0) {
+            return 0;
+        }
+
+        // SQLite 바인딩 변수 제한(999)을 넘지 않도록 나누어 INSERT
+        const columns = ['device_id', 'command', 'parameters', 'user_id', ...Object.keys(CONTROL_HISTORY_TRACE_COLUMNS)];
+        const rowsPerStatement = Math.floor(999 / columns.length);
+        const rowPlaceholder = `(${columns.map(() => '?').join(', ')})`;
+
+        return this.immediateTransaction(async () => {
+            for (let i = 0; i < rows.length; i += rowsPerStatement) {
+                const chunk = rows.slice(i, i + rowsPerStatement);
+                const placeholders = chunk.map(() => rowPlaceholder).join(', ');
+                const params = [];
+                for (const row of chunk) {
+                    params.push(...columns.map((column) => (row[column] === undefined ? null : row[column])));
+                }
+                await this.execute(
+                    `INSERT INTO control_history (${columns.join(', ')}) VALUES ${placeholders}`,
+                    params
+                );
+            }
+
+            return rows.length;
         });
     }
 
@@ -204,21 +389,68 @@ class Database {
         });
     }
 
-    // 백업 생성
-    async backup(backupPath) {
-        return new Promise((resolve, reject) => {
-            const backupDb = new sqlite3.Database(backupPath);
-            this.db.backup(backupDb, (err) => {
-                backupDb.close();
-                if (err) {
-                    logger.error('백업 생성 실패:', err);
-                    reject(err);
-                } else {
-                    logger.info('백업 생성 완료:', backupPath);
+    // 온라인 백업: sqlite3 backup API로 pagesPerStep 페이지씩 복사하고 단계 사이에 이벤트 루프를 양보
+    // 한 번에 전체를 복사하면 그동안 이 연결의 다른 쿼리(명령 기록 등)가 모두 대기함
+    // 다른 연결(클러스터 워커)이 쓰면 SQLite가 처음부터 다시 복사하므로 maxRestarts를 넘으면 중단
+    async backup(backupPath, { pagesPerStep = 64, stepDelayMs = 5, maxRestarts = 3 } = {}) {
+        const backup = await new Promise((resolve, reject) => {
+            const handle = this.db.backup(backupPath, (err) => (err ? reject(err) : resolve(handle)));
+        });
+
+        const stats = { pages: 0, steps: 0, restarts: 0, max_step_ms: 0 };
+        let previousRemaining = Infinity;
+        let lastError = null;
+
+        try {
+            while (!backup.completed && !backup.failed) {
+                const stepStartedAt = process.hrtime.bigint();
+                // SQLITE_BUSY/LOCKED는 retryErrors라 failed가 되지 않고 다음 단계에서 재시도
+                await new Promise((resolve) => backup.step(pagesPerStep, (err) => {
+                    lastError = err || null;
                     resolve();
+                }));
+                stats.steps++;
+                stats.max_step_ms = Math.max(stats.max_step_ms, Number(process.hrtime.bigint() - stepStartedAt) / 1e6);
+
+                if (backup.remaining > previousRemaining && ++stats.restarts > maxRestarts) {
+                    const error = new Error(`다른 연결의 쓰기로 백업이 ${stats.restarts}회 다시 시작되었습니다.`);
+                    error.code = 'BACKUP_RESTARTED';
+                    throw error;
                 }
-            });
+                previousRemaining = backup.remaining;
+
+                if (!backup.completed) {
+                    await new Promise((resolve) => setTimeout(resolve, stepDelayMs));
+                }
+            }
+
+            if (backup.failed) {
+                throw lastError || new Error('백업 실패');
+            }
+            stats.pages = backup.pageCount;
+            return stats;
+        } finally {
+            backup.finish();
+        }
+    }
+
+    // 별도의 읽기 전용 연결에서 VACUUM INTO로 스냅샷 생성
+    // WAL 모드에서는 쓰기를 막지 않으며, backup()이 계속 다시 시작될 때 대신 사용
+    async vacuumInto(targetPath) {
+        const reader = await new Promise((resolve, reject) => {
+            const connection = new sqlite3.Database(this.dbPath, sqlite3.OPEN_READONLY, (err) => (
+                err ? reject(err) : resolve(connection)
+            ));
         });
+
+        try {
+            reader.configure('busyTimeout', BUSY_TIMEOUT_MS);
+            await new Promise((resolve, reject) => {
+                reader.run('VACUUM INTO ?', [targetPath], (err) => (err ? reject(err) : resolve()));
+            });
+        } finally {
+            await new Promise((resolve) => reader.close(() => resolve()));
+        }
     }
 }
 
@@ -0,0 +1,87 @@
+const crypto = require('crypto');
+
+// 펌웨어 api_auth.h와 같은 인증 형식
+// - Bearer: Authorization: Bearer <키>
+// - 서명:   Authorization: HMAC <키 ID>:<nonce>:<서명 hex>
+//           서명 = HMAC-SHA256(MAC 키, "<메서드>\n<URI>\n<부팅 ID>\n<nonce>\n<본문 SHA-256>\n<X-Image-SHA256>\n<Content-Range>")
+//           부팅 ID는 401 응답의 WWW-Authenticate: HMAC boot=<hex>로 받음
+//           본문 SHA-256(hex)은 X-Content-SHA256 헤더로 함께 보내고, 없는 헤더는 빈 문자열로 서명
+// 시뮬레이터도 사용하므로 crypto 외의 의존성 없음
+const SCOPES = ['read', 'control', 'admin'];
+const UNKNOWN_BOOT_ID = '00000000';
+
+// 디바이스는 키 원문 대신 원문에서 유도한 두 값을 저장
+// - 검증 해시 SHA-256(키): Bearer 비교용
+// - MAC 키 HMAC-SHA256(키, "mac"): 서명 요청과 UDP 명령 채널의 HMAC 키
+const MAC_KEY_LABEL = 'mac';
+const hashes = new Map();
+const macKeys = new Map();
+
+function keyHash(key) {
+    let hash = hashes.get(key);
+    if (!hash) {
+        hash = crypto.createHash('sha256').update(key).digest();
+        hashes.set(key, hash);
+    }
+    return hash;
+}
+
+function macKey(key) {
+    let derived = macKeys.get(key);
+    if (!derived) {
+        derived = crypto.createHmac('sha256', key).update(MAC_KEY_LABEL).digest();
+        macKeys.set(key, derived);
+    }
+    return derived;
+}
+
+// 요청 본문(문자열/Buffer, 없으면 빈 본문)의 SHA-256 hex
+function contentHash(body) {
+    return crypto.createHash('sha256').update(body === undefined || body === null ? '' : body).digest('hex');
+}
+
+// bound: 서명에 함께 묶는 헤더 값 { contentSha256, imageSha256, contentRange }
+function signature(key, method, uri, bootId, nonce, bound = {}) {
+    const message = [
+        method, uri, bootId, nonce,
+        bound.contentSha256 || '', bound.imageSha256 || '', bound.contentRange || ''
+    ].join('\n');
+    return crypto.createHmac('sha256', macKey(key)).update(message).digest('hex');
+}
+
+function signRequest({ keyId, key, method, uri, bootId, nonce, ...bound }) {
+    return `HMAC ${keyId}:${nonce}:${signature(key, method.toUpperCase(), uri, bootId || UNKNOWN_BOOT_ID, nonce, bound)}`;
+}
+
+// WWW-Authenticate 헤더에서 부팅 ID 추출
+function parseChallenge(header) {
+    const match = /^HMAC boot=([0-9a-f]{8})$/.exec(header || '');
+    return match ? match[1] : null;
+}
+
+// 서명 헤더 파싱 (시뮬레이터용), 형식이 틀리면 null
+function parseSigned(header) {
+    const match = /^HMAC ([A-Za-z0-9_-]{1,15}):(\d{1,20}):([0-9a-fA-F]{64})$/.exec(header || '');
+    return match ? { keyId: match[1], nonce: BigInt(match[2]), signature: Buffer.from(match[3], 'hex') } : null;
+}
+
+function verifySignature(key, method, uri, bootId, parsed, bound) {
+    const expected = Buffer.from(signature(key, method, uri, bootId, parsed.nonce, bound), 'hex');
+    return crypto.timingSafeEqual(expected, parsed.signature);
+}
+
+function constantTimeEqual(a, b) {
+    return a.length === b.length && crypto.timingSafeEqual(a, b);
+}
+
+module.exports = {
+    SCOPES,
+    keyHash,
+    macKey,
+    contentHash,
+    signRequest,
+    parseChallenge,
+    parseSigned,
+    verifySignature,
+    constantTimeEqual
+};
@@ -0,0 +1,282 @@
+const axios = require('axios');
+const http = require('http');
+const logger = require('./logger');
+const udpClient = require('./udpClient');
+const udpProtocol = require('./udpProtocol');
+const deviceAuth = require('./deviceAuth');
+const { createKeyedQueue } = require('./concurrency');
+
+// ESP32 httpd는 동시 소켓 수가 적으므로 디바이스당 연결 수를 제한하고 keep-alive로 재사용
+const MAX_SOCKETS_PER_DEVICE = parseInt(process.env.DEVICE_MAX_SOCKETS, 10) || 2;
+const REQUEST_TIMEOUT_MS = parseInt(process.env.DEVICE_REQUEST_TIMEOUT_MS, 10) || 5000;
+// devices.transport가 비어 있는 디바이스의 명령 전송 방식 ('http' | 'udp')
+const DEFAULT_TRANSPORT = process.env.DEVICE_TRANSPORT || 'http';
+// devices.auth_mode가 비어 있는 디바이스의 인증 방식 ('bearer' | 'hmac')
+const DEFAULT_AUTH_MODE = process.env.DEVICE_AUTH_MODE || 'bearer';
+const DEFAULT_KEY_ID = process.env.DEVICE_API_KEY_ID || 'default';
+const EMPTY_CONTENT_SHA256 = deviceAuth.contentHash('');
+
+// 제어 페이로드 → 펌웨어 엔드포인트 매핑 (prefix: UDP 명령 이름 접두어)
+const COMMANDS = {
+    power: { path: '/api/aircon/power', field: 'power', values: ['on', 'off'], prefix: 'power' },
+    temp: { path: '/api/aircon/temp', field: 'action', values: ['up', 'down'], prefix: 'temp' },
+    mode: { path: '/api/aircon/mode', field: 'mode', values: ['cool', 'heat', 'fan'], prefix: 'mode' }
+};
+
+class DeviceClient {
+    constructor() {
+        this.agent = new http.Agent({
+            keepAlive: true,
+            maxSockets: MAX_SOCKETS_PER_DEVICE,
+            maxFreeSockets: MAX_SOCKETS_PER_DEVICE
+        });
+
+        this.http = axios.create({
+            httpAgent: this.agent,
+            timeout: REQUEST_TIMEOUT_MS,
+            // 상태 코드는 호출 측에서 판단
+            validateStatus: () => true
+        });
+
+        // 서명 요청용: 디바이스별 부팅 ID, 요청마다 증가하는 nonce
+        // (서버를 재시작해도 이전 값보다 커지도록 현재 시각(마이크로초)에서 시작)
+        this.bootIds = new Map();
+        this.nonce = 0;
+        // 디바이스는 키마다 이전보다 큰 nonce만 받으므로, keep-alive 소켓 여러 개로 보내면
+        // 나중에 서명한 요청이 먼저 도착해 앞 요청이 거부될 수 있음 → 디바이스(주소)별로 하나씩 서명/전송
+        this.signedQueue = createKeyedQueue();
+    }
+
+    isSigned(device) {
+        return (device.auth_mode || DEFAULT_AUTH_MODE) === 'hmac';
+    }
+
+    baseUrl(device) {
+        return `http://${device.ip_address}:${device.port || 80}`;
+    }
+
+    // 서명 방식이면 키 원문 대신 메서드/경로/부팅 ID/nonce/본문 해시 서명을 전송
+    // (OTA의 X-Image-SHA256, Content-Range도 extraHeaders에 있으면 서명에 포함)
+    headers(device, method = 'GET', uri = '/', contentSha256 = EMPTY_CONTENT_SHA256, extraHeaders = {}) {
+        if (!this.isSigned(device)) {
+            return { Authorization: `Bearer ${device.api_key}` };
+        }
+
+        this.nonce = Math.max(this.nonce + 1, Date.now() * 1000);
+        return {
+            Authorization: deviceAuth.signRequest({
+                keyId: device.api_key_id || DEFAULT_KEY_ID,
+                key: device.api_key,
+                method,
+                uri,
+                bootId: this.bootIds.get(device.id),
+                nonce: this.nonce,
+                contentSha256,
+                imageSha256: extraHeaders['X-Image-SHA256'],
+                contentRange: extraHeaders['Content-Range']
+            }),
+            'X-Content-SHA256': contentSha256
+        };
+    }
+
+    // 401 응답의 부팅 ID가 알고 있던 값과 다르면(첫 요청, 디바이스 재부팅) 갱신하고 true
+    updateBootId(device, response) {
+        const bootId = response.status === 401 && deviceAuth.parseChallenge(response.headers['www-authenticate']);
+        if (!bootId || !this.isSigned(device) || this.bootIds.get(device.id) === bootId) {
+            return false;
+        }
+        this.bootIds.set(device.id, bootId);
+        return true;
+    }
+
+    // 디바이스 REST 요청, 서명 방식이면 디바이스별로 하나씩 보내고 401이면 다시 서명해서 재시도
+    // - 부팅 ID가 바뀐 경우(첫 요청, 재부팅): 받은 부팅 ID로 한 번
+    // - 그 밖의 401(다른 서버 프로세스가 더 큰 nonce를 먼저 보내 거부된 경우 등): 새 nonce로 한 번
+    //   (펌웨어는 nonce 거부와 키 불일치를 구분하지 않으므로 키가 틀려도 한 번은 재시도됨)
+    // 스트림 본문은 다시 보낼 수 없으므로 data에 스트림을 만드는 함수를 넘기면 시도마다 새로 만듦
+    // 객체 본문은 서명한 해시와 같은 바이트를 보내도록 직접 JSON으로 직렬화하고,
+    // 스트림 본문은 호출 측이 contentSha256(hex)을 넘겨야 함
+    async request(device, method, uri, { data, headers = {}, contentSha256, ...config } = {}) {
+        let body = data;
+        if (data !== undefined && data !== null && typeof data === 'object' && !Buffer.isBuffer(data)) {
+            body = Buffer.from(JSON.stringify(data));
+            headers = { 'Content-Type': 'application/json', ...headers };
+        }
+        if (!contentSha256) {
+            if (typeof body === 'function') {
+                throw new Error('스트림 본문은 contentSha256이 필요합니다');
+            }
+            contentSha256 = deviceAuth.contentHash(body);
+        }
+
+        const send = () => this.http.request({
+            method,
+            url: this.baseUrl(device) + uri,
+            data: typeof body === 'function' ? body() : body,
+            headers: { ...this.headers(device, method, uri, contentSha256, headers), ...headers },
+            ...config
+        });
+
+        if (!this.isSigned(device)) {
+            return send();
+        }
+
+        return this.signedQueue(this.baseUrl(device), async () => {
+            let bootRetried = false;
+            let nonceRetried = false;
+            for (;;) {
+                const response = await send();
+                if (response.status !== 401) {
+                    return response;
+                }
+                if (!bootRetried && this.updateBootId(device, response)) {
+                    bootRetried = true;
+                } else if (!nonceRetried) {
+                    nonceRetried = true;
+                    logger.debug(`디바이스 ${device.id} 서명 요청 거부, 새 nonce로 재시도: ${method} ${uri}`);
+                } else {
+                    return response;
+                }
+            }
+        });
+    }
+
+    // 설정 페이지와 같은 형식({ power }, { action }, { mode })의 페이로드를 명령으로 변환
+    normalizeCommand(payload) {
+        if (!payload || typeof payload !== 'object') {
+            return null;
+        }
+
+        for (const [command, spec] of Object.entries(COMMANDS)) {
+            const value = payload[spec.field];
+            if (value !== undefined) {
+                if (!spec.values.includes(value)) {
+                    return null;
+                }
+                return {
+                    command,
+                    path: spec.path,
+                    body: { [spec.field]: value },
+                    steps: [{ command: `${spec.prefix}_${value}`, count: 1 }]
+                };
+            }
+        }
+
+        return null;
+    }
+
+    transport(device) {
+        return device.transport || DEFAULT_TRANSPORT;
+    }
+
+    // 단일 디바이스에 명령 전송 (requestId는 X-Request-ID로 전달되어 펌웨어 응답의 trace에 포함됨)
+    // UDP 디바이스는 고정 레이아웃에 들어가는 명령만 UDP로, 나머지는 REST로 전송
+    async sendCommand(device, command, options = {}) {
+        if (this.transport(device) === 'udp' && udpProtocol.canEncode(command.steps)) {
+            return this.sendUdp(device, command, options);
+        }
+
+        const startedAt = process.hrtime.bigint();
+        const headers = {};
+        if (options.requestId) {
+            headers['X-Request-ID'] = options.requestId;
+        }
+
+        try {
+            const response = await this.request(device, 'POST', command.path, { data: command.body, headers });
+
+            const durationMs = Number(process.hrtime.bigint() - startedAt) / 1e6;
+            const ok = response.status >= 200 && response.status < 300 &&
+                (!response.data || response.data.status !== 'error');
+
+            return {
+                device_id: device.id,
+                ok,
+                http_status: response.status,
+                duration_ms: durationMs,
+                response: response.data,
+                ...(ok ? {} : { error: (response.data && response.data.message) || `HTTP ${response.status}` })
+            };
+        } catch (error) {
+            const durationMs = Number(process.hrtime.bigint() - startedAt) / 1e6;
+            logger.warn(`디바이스 ${device.id} 명령 전송 실패: ${error.message}`);
+
+            return {
+                device_id: device.id,
+                ok: false,
+                http_status: null,
+                duration_ms: durationMs,
+                error: error.code || error.message
+            };
+        }
+    }
+
+    // UDP 명령 채널 전송, 결과는 REST와 같은 형식 (http_status는 ack 상태에 대응하는 코드)
+    // 재전송은 udpClient가 처리하고, 시간 초과 시 실제 전송 여부를 알 수 없으므로 REST로 재시도하지 않음
+    async sendUdp(device, command, options = {}) {
+        const startedAt = process.hrtime.bigint();
+
+        try {
+            const ack = await udpClient.send(device, command.steps, { gapMs: command.body && command.body.gap_ms });
+            const durationMs = Number(process.hrtime.bigint() - startedAt) / 1e6;
+            const ok = ack.status === 'ok';
+
+            return {
+                device_id: device.id,
+                ok,
+                transport: 'udp',
+                http_status: ack.http_status,
+                duration_ms: durationMs,
+                attempts: ack.attempts,
+                response: {
+                    status: ok ? 'success' : 'error',
+                    message: ok ? '명령이 전송되었습니다' : `UDP 명령 실패: ${ack.status}`,
+                    executed: ack.executed,
+                    total: ack.total,
+                    trace: { request_id: options.requestId || null, ...ack.trace }
+                },
+                ...(ok ? {} : { error: `UDP ${ack.status}` })
+            };
+        } catch (error) {
+            const durationMs = Number(process.hrtime.bigint() - startedAt) / 1e6;
+            logger.warn(`디바이스 ${device.id} UDP 명령 전송 실패: ${error.message}`);
+
+            return {
+                device_id: device.id,
+                ok: false,
+                transport: 'udp',
+                http_status: null,
+                duration_ms: durationMs,
+                error: error.code || error.message
+            };
+        }
+    }
+
+    // 플래너가 계산한 명령 시퀀스를 한 번의 요청으로 전송 (펌웨어 POST /api/aircon/sequence)
+    // executed: 디바이스가 실제로 전송한 명령 수 (중간 실패 시 상태 모델에 일부만 반영)
+    async sendSequence(device, steps, options = {}) {
+        const result = await this.sendCommand(device, {
+            command: 'sequence',
+            path: '/api/aircon/sequence',
+            body: { steps },
+            steps
+        }, options);
+
+        const data = result.response;
+        result.executed = data && Number.isInteger(data.executed) ? data.executed : 0;
+        return result;
+    }
+
+    // 디바이스 상태 조회
+    async getStatus(device) {
+        const response = await this.request(device, 'GET', '/api/status');
+
+        if (response.status !== 200) {
+            throw new Error(`HTTP ${response.status}`);
+        }
+
+        return response.data;
+    }
+}
+
+module.exports = new DeviceClient();
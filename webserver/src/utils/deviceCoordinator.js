@@ -0,0 +1,145 @@
+const ipc = require('./ipc');
+const deviceClient = require('./deviceClient');
+const logger = require('./logger');
+const { createKeyedQueue } = require('./concurrency');
+
+// 잠금 대기 최대 시간: 넘으면 대기 중인 요청을 실패 처리 (멈춘 작업이 요청을 계속 붙잡지 않도록)
+// 잠금은 작업이 실제로 끝날 때까지 넘기지 않으므로 앞 작업의 IR 전송과 겹쳐 실행되지 않음
+const LOCK_WAIT_MS = parseInt(process.env.DEVICE_LOCK_WAIT_MS, 10) || 60000;
+
+// 디바이스 통신 단일 창구 (명령, 상태 조회, OTA 모두 여기를 거침)
+// - 디바이스별로 요청을 하나씩 순서대로 전송 (httpd/UDP 태스크가 어차피 순차 처리하므로 서버에서 줄 세움)
+// - withLock: 상태 조회 → 명령 계획 → 전송 → 기록 구간을 디바이스별로 직렬화
+// 클러스터 모드에서는 primary만 디바이스에 연결하고 워커는 IPC로 위임하므로
+// 워커가 몇 개든 디바이스별 연결 수와 명령 순서가 단일 프로세스와 같음
+class DeviceCoordinator {
+    constructor() {
+        this.sendQueue = createKeyedQueue();
+        this.lockQueue = createKeyedQueue();
+        // lockId → { release, workerId } (워커가 잡고 있는 잠금)
+        this.held = new Map();
+        // 차례를 기다리는 워커의 잠금 요청 ({ workerId, cancelled })
+        this.waiting = new Set();
+        this.nextLockId = 1;
+    }
+
+    sendCommand(device, command, options = {}) {
+        if (ipc.isWorker) {
+            return ipc.request('device:command', { device, command, options });
+        }
+        return this.sendQueue(device.id, () => deviceClient.sendCommand(device, command, options));
+    }
+
+    sendSequence(device, steps, options = {}) {
+        if (ipc.isWorker) {
+            return ipc.request('device:sequence', { device, steps, options });
+        }
+        return this.sendQueue(device.id, () => deviceClient.sendSequence(device, steps, options));
+    }
+
+    getStatus(device) {
+        if (ipc.isWorker) {
+            return ipc.request('device:status', { device });
+        }
+        return this.sendQueue(device.id, () => deviceClient.getStatus(device));
+    }
+
+    // 그 밖의 REST 요청 (OTA 상태 조회/이미지 전송), primary 전용 (스트림 본문은 IPC로 넘길 수 없음)
+    request(device, method, uri, options) {
+        return this.sendQueue(device.id, () => deviceClient.request(device, method, uri, options));
+    }
+
+    // 차례가 오면 hold()를 실행하고, hold()가 돌려준 promise가 끝날 때까지 다음 차례를 막음
+    // LOCK_WAIT_MS 안에 차례가 오지 않으면 timedOut(error)을 부르고 차례가 와도 건너뜀
+    waitTurn(deviceId, hold, timedOut) {
+        let expired = false;
+        const timer = setTimeout(() => {
+            expired = true;
+            logger.warn(`디바이스 ${deviceId} 잠금을 ${LOCK_WAIT_MS}ms 동안 얻지 못해 요청을 취소함`);
+            const error = new Error(`디바이스 ${deviceId}의 이전 작업이 끝나지 않았습니다.`);
+            error.code = 'ELOCKTIMEOUT';
+            timedOut(error);
+        }, LOCK_WAIT_MS);
+
+        this.lockQueue(deviceId, () => {
+            clearTimeout(timer);
+            return expired ? undefined : hold();
+        });
+    }
+
+    async withLock(deviceId, task) {
+        if (!ipc.isWorker) {
+            return new Promise((resolve, reject) => {
+                this.waitTurn(deviceId, () => {
+                    const running = Promise.resolve().then(task);
+                    running.then(resolve, reject);
+                    return running.catch(() => {});
+                }, reject);
+            });
+        }
+
+        const lockId = await ipc.request('device:lock', { deviceId });
+        try {
+            return await task();
+        } finally {
+            ipc.notify('device:unlock', { lockId });
+        }
+    }
+
+    release(lockId) {
+        const lock = this.held.get(lockId);
+        if (lock) {
+            this.held.delete(lockId);
+            lock.release();
+        }
+    }
+
+    // primary: 워커 요청 처리 등록
+    serve() {
+        ipc.handle('device:command', ({ device, command, options }) => this.sendCommand(device, command, options));
+        ipc.handle('device:sequence', ({ device, steps, options }) => this.sendSequence(device, steps, options));
+        ipc.handle('device:status', ({ device }) => this.getStatus(device));
+
+        // 잠금 차례가 오면 lockId로 응답하고, 워커가 unlock을 보내거나 종료될 때까지 다음 차례를 막음
+        ipc.handle('device:lock', ({ deviceId }, worker) => new Promise((granted, cancelled) => {
+            const request = { workerId: worker.id, cancelled: false, cancel: cancelled };
+            this.waiting.add(request);
+
+            this.waitTurn(deviceId, () => {
+                this.waiting.delete(request);
+                // 기다리는 동안 종료된 워커의 차례는 건너뜀
+                if (request.cancelled) {
+                    return undefined;
+                }
+
+                const lockId = this.nextLockId++;
+                const held = new Promise((release) => {
+                    this.held.set(lockId, { release, workerId: worker.id });
+                });
+                granted(lockId);
+                return held;
+            }, (error) => {
+                this.waiting.delete(request);
+                cancelled(error);
+            });
+        }));
+        ipc.on('device:unlock', ({ lockId }) => this.release(lockId));
+
+        // 종료된 워커의 잠금 해제, 대기 중인 요청 취소
+        ipc.on('worker-exit', (worker) => {
+            for (const [lockId, lock] of this.held) {
+                if (lock.workerId === worker.id) {
+                    this.release(lockId);
+                }
+            }
+            for (const request of this.waiting) {
+                if (request.workerId === worker.id) {
+                    request.cancelled = true;
+                    request.cancel(new Error('워커가 종료되었습니다.'));
+                }
+            }
+        });
+    }
+}
+
+module.exports = new DeviceCoordinator();
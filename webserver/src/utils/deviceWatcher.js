@@ -0,0 +1,154 @@
+const database = require('./database');
+const deviceCoordinator = require('./deviceCoordinator');
+const eventHub = require('./eventHub');
+const ipc = require('./ipc');
+const logger = require('./logger');
+
+const POLL_INTERVAL_MS = parseInt(process.env.DEVICE_POLL_INTERVAL_MS, 10) || 5000;
+
+// 디바이스당 하나의 상태 조회 루프를 두고 모든 구독자가 공유
+// 클러스터 모드에서는 primary에서만 조회하고 워커는 구독 요청만 전달 (상태 변화는 eventHub로 수신)
+class DeviceWatcher {
+    constructor() {
+        this.watches = new Map();
+        // workerId → Map(deviceId → 구독 수), 종료된 워커의 구독 정리용
+        this.workerRefs = new Map();
+    }
+
+    // 마지막으로 확인된 상태 반환 (첫 구독이면 null, 워커에서는 Promise)
+    subscribe(deviceId) {
+        if (ipc.isWorker) {
+            return ipc.request('watcher:subscribe', { deviceId });
+        }
+
+        let watch = this.watches.get(deviceId);
+        if (watch) {
+            watch.refs++;
+            return watch.state;
+        }
+
+        watch = { refs: 1, timer: null, state: null, stopped: false };
+        this.watches.set(deviceId, watch);
+        this.poll(deviceId, watch);
+        return null;
+    }
+
+    unsubscribe(deviceId) {
+        if (ipc.isWorker) {
+            ipc.notify('watcher:unsubscribe', { deviceId });
+            return;
+        }
+
+        const watch = this.watches.get(deviceId);
+        if (!watch || --watch.refs > 0) {
+            return;
+        }
+
+        watch.stopped = true;
+        clearTimeout(watch.timer);
+        this.watches.delete(deviceId);
+    }
+
+    // 마지막으로 확인된 상태
+    snapshot(deviceId) {
+        const watch = this.watches.get(deviceId);
+        return watch ? watch.state : null;
+    }
+
+    async poll(deviceId, watch) {
+        const state = await this.fetchState(deviceId);
+        if (watch.stopped) {
+            return;
+        }
+
+        this.update(deviceId, watch, state);
+        watch.timer = setTimeout(() => this.poll(deviceId, watch), POLL_INTERVAL_MS);
+    }
+
+    async fetchState(deviceId) {
+        const device = await database.get('SELECT * FROM devices WHERE id = ?', [deviceId]).catch(() => null);
+        if (!device) {
+            return { device_id: deviceId, online: false, error: '디바이스를 찾을 수 없습니다.' };
+        }
+
+        try {
+            const status = await deviceCoordinator.getStatus(device);
+            return { device_id: deviceId, online: true, wifi_status: status.wifi_status, version: status.version };
+        } catch (error) {
+            return { device_id: deviceId, online: false, error: error.code || error.message };
+        }
+    }
+
+    // 상태가 바뀐 경우에만 DB 갱신 및 이벤트 발행
+    update(deviceId, watch, state) {
+        const previous = watch ? watch.state : null;
+        if (watch) {
+            watch.state = state;
+        }
+
+        if (previous && previous.online === state.online &&
+            previous.wifi_status === state.wifi_status && previous.version === state.version) {
+            return;
+        }
+
+        eventHub.publish('device-state', state, deviceId);
+
+        const sql = state.online
+            ? "UPDATE devices SET status = 'online', last_seen = CURRENT_TIMESTAMP WHERE id = ?"
+            : "UPDATE devices SET status = 'offline' WHERE id = ?";
+        database.run(sql, [deviceId]).catch((error) => {
+            logger.warn(`디바이스 ${deviceId} 상태 저장 실패: ${error.message}`);
+        });
+    }
+
+    // 연결 테스트: 즉시 조회하고 결과를 구독자에게도 알림
+    async testConnection(deviceId) {
+        if (ipc.isWorker) {
+            return ipc.request('watcher:test', { deviceId });
+        }
+
+        const state = await this.fetchState(deviceId);
+        this.update(deviceId, this.watches.get(deviceId), state);
+        eventHub.publish('connection-test', state, deviceId);
+        return state;
+    }
+
+    trackWorker(worker, deviceId, delta) {
+        let refs = this.workerRefs.get(worker.id);
+        if (!refs) {
+            refs = new Map();
+            this.workerRefs.set(worker.id, refs);
+        }
+        const count = (refs.get(deviceId) || 0) + delta;
+        if (count > 0) {
+            refs.set(deviceId, count);
+        } else {
+            refs.delete(deviceId);
+        }
+    }
+
+    // primary: 워커 요청 처리 등록
+    serve() {
+        ipc.handle('watcher:subscribe', ({ deviceId }, worker) => {
+            this.trackWorker(worker, deviceId, 1);
+            return this.subscribe(deviceId);
+        });
+        ipc.on('watcher:unsubscribe', ({ deviceId }, worker) => {
+            this.trackWorker(worker, deviceId, -1);
+            this.unsubscribe(deviceId);
+        });
+        ipc.handle('watcher:test', ({ deviceId }) => this.testConnection(deviceId));
+
+        ipc.on('worker-exit', (worker) => {
+            const refs = this.workerRefs.get(worker.id) || new Map();
+            for (const [deviceId, count] of refs) {
+                for (let i = 0; i < count; i++) {
+                    this.unsubscribe(deviceId);
+                }
+            }
+            this.workerRefs.delete(worker.id);
+        });
+    }
+}
+
+module.exports = new DeviceWatcher();
@@ -0,0 +1,143 @@
+const logger = require('./logger');
+const ipc = require('./ipc');
+
+// 클라이언트당 최대 대기 이벤트 수 (초과 시 가장 오래된 이벤트부터 버림)
+const MAX_CLIENT_BUFFER = parseInt(process.env.EVENT_CLIENT_BUFFER, 10) || 100;
+const HEARTBEAT_INTERVAL_MS = 25000;
+
+// SSE 클라이언트: 소켓이 밀리면 이벤트를 제한된 버퍼에 쌓고 drain 시 내보냄
+class SseClient {
+    constructor(res, deviceIds) {
+        this.res = res;
+        this.deviceIds = new Set(deviceIds);
+        this.queue = [];
+        this.dropped = 0;
+        this.waiting = false;
+
+        res.on('drain', () => this.flush());
+    }
+
+    push(frame) {
+        if (this.waiting) {
+            if (this.queue.length >= MAX_CLIENT_BUFFER) {
+                this.queue.shift();
+                this.dropped++;
+            }
+            this.queue.push(frame);
+            return;
+        }
+        this.write(frame);
+    }
+
+    write(frame) {
+        if (this.res.writableEnded || this.res.destroyed) {
+            return;
+        }
+        if (!this.res.write(frame)) {
+            this.waiting = true;
+        }
+    }
+
+    flush() {
+        this.waiting = false;
+
+        // 버린 이벤트가 있으면 클라이언트가 전체 상태를 다시 받아갈 수 있도록 알림
+        if (this.dropped > 0) {
+            this.write(`event: dropped\ndata: ${JSON.stringify({ count: this.dropped })}\n\n`);
+            this.dropped = 0;
+        }
+
+        while (this.queue.length > 0 && !this.waiting) {
+            this.write(this.queue.shift());
+        }
+    }
+
+    wants(deviceId) {
+        return deviceId === undefined || deviceId === null || this.deviceIds.has(deviceId);
+    }
+}
+
+class EventHub {
+    constructor() {
+        this.clients = new Set();
+        this.nextEventId = 1;
+        this.heartbeat = null;
+
+        // 클러스터 모드: 다른 프로세스(디바이스 상태 조회, 다른 워커의 명령)에서 발행한 이벤트도 전달
+        ipc.on('event', ({ event, data, deviceId }) => this.deliver(event, data, deviceId));
+    }
+
+    // SSE 응답을 열고 클라이언트 등록
+    addClient(res, deviceIds) {
+        res.status(200);
+        res.set({
+            'Content-Type': 'text/event-stream; charset=utf-8',
+            'Cache-Control': 'no-cache',
+            'Connection': 'keep-alive',
+            'X-Accel-Buffering': 'no'
+        });
+        res.flushHeaders();
+        res.write('retry: 3000\n\n');
+
+        const client = new SseClient(res, deviceIds);
+        this.clients.add(client);
+
+        if (!this.heartbeat) {
+            this.heartbeat = setInterval(() => this.sendHeartbeat(), HEARTBEAT_INTERVAL_MS);
+            this.heartbeat.unref();
+        }
+
+        logger.debug(`이벤트 스트림 연결 (${this.clients.size}개)`);
+        return client;
+    }
+
+    removeClient(client) {
+        this.clients.delete(client);
+
+        if (this.clients.size === 0 && this.heartbeat) {
+            clearInterval(this.heartbeat);
+            this.heartbeat = null;
+        }
+    }
+
+    // 특정 클라이언트에게만 이벤트 전송 (접속 직후 현재 상태 전달용)
+    sendTo(client, event, data) {
+        client.push(this.format(event, data));
+    }
+
+    // deviceId가 있으면 해당 디바이스를 구독하는 클라이언트에게만 전달
+    publish(event, data, deviceId) {
+        this.deliver(event, data, deviceId);
+        if (ipc.clustered) {
+            ipc.publish('event', { event, data, deviceId });
+        }
+    }
+
+    deliver(event, data, deviceId) {
+        if (this.clients.size === 0) {
+            return;
+        }
+
+        const frame = this.format(event, data);
+        for (const client of this.clients) {
+            if (client.wants(deviceId)) {
+                client.push(frame);
+            }
+        }
+    }
+
+    format(event, data) {
+        return `id: ${this.nextEventId++}\nevent: ${event}\ndata: ${JSON.stringify(data)}\n\n`;
+    }
+
+    // 연결 유지용이므로 대기 버퍼에 넣지 않음 (소켓이 밀려 있으면 보낼 필요도 없고, 버퍼의 이벤트를 밀어낼 수 있음)
+    sendHeartbeat() {
+        for (const client of this.clients) {
+            if (!client.waiting) {
+                client.write(': ping\n\n');
+            }
+        }
+    }
+}
+
+module.exports = new EventHub();
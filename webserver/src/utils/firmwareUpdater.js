@@ -0,0 +1,250 @@
+const crypto = require('crypto');
+const fs = require('fs');
+const path = require('path');
+const database = require('./database');
+const deviceCoordinator = require('./deviceCoordinator');
+const eventHub = require('./eventHub');
+const ipc = require('./ipc');
+const { forEachBounded } = require('./concurrency');
+const logger = require('./logger');
+
+const FIRMWARE_DIR = process.env.FIRMWARE_DIR || path.join(__dirname, '../../data/firmware');
+const UPLOAD_TIMEOUT_MS = 120000;
+const MAX_UPLOAD_ATTEMPTS = 5;
+const BOOT_TIMEOUT_MS = parseInt(process.env.FIRMWARE_BOOT_TIMEOUT_MS, 10) || 90000;
+const BOOT_POLL_INTERVAL_MS = 2000;
+
+const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+
+class FirmwareUpdater {
+    constructor() {
+        this.firmwareDir = FIRMWARE_DIR;
+    }
+
+    imagePath(image) {
+        return path.join(this.firmwareDir, image.filename);
+    }
+
+    async getOtaStatus(device) {
+        const response = await deviceCoordinator.request(device, 'GET', '/api/ota');
+        if (response.status !== 200) {
+            throw new Error(`OTA 상태 조회 실패 (HTTP ${response.status})`);
+        }
+        return response.data;
+    }
+
+    // 이미지 파일의 start 이후 구간 SHA-256 hex (서명 요청의 X-Content-SHA256)
+    hashRange(image, start) {
+        return new Promise((resolve, reject) => {
+            const hash = crypto.createHash('sha256');
+            fs.createReadStream(this.imagePath(image), { start })
+                .on('data', (chunk) => hash.update(chunk))
+                .on('end', () => resolve(hash.digest('hex')))
+                .on('error', reject);
+        });
+    }
+
+    // 이미지를 디바이스의 비활성 파티션으로 스트리밍 (끊기면 디바이스가 받은 위치부터 재개)
+    // 다른 요청과 같은 디바이스별 전송 대기열을 거치므로 전송 중에는 상태 조회/명령이 끝날 때까지 기다림
+    async pushImage(device, image, onProgress) {
+        let lastError = null;
+
+        for (let attempt = 1; attempt <= MAX_UPLOAD_ATTEMPTS; attempt++) {
+            try {
+                const status = await this.getOtaStatus(device);
+                const offset = status.active && status.sha256 === image.sha256 && status.image_size === image.size
+                    ? status.received
+                    : 0;
+
+                const response = await deviceCoordinator.request(device, 'POST', '/api/ota', {
+                    data: () => fs.createReadStream(this.imagePath(image), { start: offset }),
+                    contentSha256: await this.hashRange(image, offset),
+                    headers: {
+                        'Content-Type': 'application/octet-stream',
+                        'Content-Length': image.size - offset,
+                        'Content-Range': `bytes ${offset}-${image.size - 1}/${image.size}`,
+                        'X-Image-SHA256': image.sha256
+                    },
+                    maxBodyLength: Infinity,
+                    timeout: UPLOAD_TIMEOUT_MS
+                });
+
+                if (onProgress) {
+                    onProgress(response.data && response.data.received !== undefined ? response.data.received : image.size);
+                }
+
+                if (response.status === 200) {
+                    return response.data.target_partition;
+                }
+                if (response.status === 422 || response.status === 413) {
+                    // 해시/이미지 검증 실패는 재시도해도 같은 결과
+                    throw Object.assign(new Error(response.data.message || `HTTP ${response.status}`), { fatal: true });
+                }
+
+                lastError = new Error(`HTTP ${response.status}`);
+            } catch (error) {
+                if (error.fatal) {
+                    throw error;
+                }
+                lastError = error;
+                logger.warn(`디바이스 ${device.id} 펌웨어 전송 재시도 (${attempt}/${MAX_UPLOAD_ATTEMPTS}): ${error.message}`);
+            }
+
+            await sleep(1000 * attempt);
+        }
+
+        throw lastError;
+    }
+
+    // 재부팅 후 새 파티션으로 부팅되어 확정되었는지 확인 (롤백되면 실패)
+    async waitForBoot(device, expectedPartition) {
+        const deadline = Date.now() + BOOT_TIMEOUT_MS;
+        let wentOffline = false;
+
+        await sleep(BOOT_POLL_INTERVAL_MS);
+        while (Date.now() < deadline) {
+            try {
+                const status = await this.getOtaStatus(device);
+                if (status.running_partition === expectedPartition && !status.pending_verify) {
+                    return status.version;
+                }
+                if (wentOffline && status.running_partition !== expectedPartition) {
+                    throw Object.assign(new Error('이전 펌웨어로 롤백됨'), { fatal: true });
+                }
+            } catch (error) {
+                if (error.fatal) {
+                    throw error;
+                }
+                wentOffline = true;
+            }
+            await sleep(BOOT_POLL_INTERVAL_MS);
+        }
+
+        throw new Error('부팅 확인 시간 초과');
+    }
+
+    async setDeviceStatus(rolloutId, deviceId, fields) {
+        const columns = Object.keys(fields).map((key) => `${key} = ?`).join(', ');
+        await database.run(
+            `UPDATE firmware_rollout_devices SET ${columns}, updated_at = CURRENT_TIMESTAMP
+             WHERE rollout_id = ? AND device_id = ?`,
+            [...Object.values(fields), rolloutId, deviceId]
+        );
+        eventHub.publish('firmware-rollout', { rollout_id: rolloutId, device_id: deviceId, ...fields }, deviceId);
+    }
+
+    async updateDevice(rolloutId, device, image) {
+        try {
+            await this.setDeviceStatus(rolloutId, device.id, { status: 'uploading' });
+            const partition = await this.pushImage(device, image, (bytes) => {
+                this.setDeviceStatus(rolloutId, device.id, { bytes_sent: bytes }).catch(() => {});
+            });
+
+            await this.setDeviceStatus(rolloutId, device.id, { status: 'rebooting', bytes_sent: image.size });
+            const version = await this.waitForBoot(device, partition);
+
+            await this.setDeviceStatus(rolloutId, device.id, { status: 'succeeded' });
+            logger.info(`디바이스 ${device.id} 펌웨어 업데이트 완료 (${version})`);
+            return { ok: true };
+        } catch (error) {
+            await this.setDeviceStatus(rolloutId, device.id, { status: 'failed', error: error.message });
+            logger.error(`디바이스 ${device.id} 펌웨어 업데이트 실패: ${error.message}`);
+            return { ok: false, error: error.message };
+        }
+    }
+
+    // 단계별 배포: 각 단계를 제한된 동시성으로 진행하고 실패가 허용치를 넘으면 중단
+    // 클러스터 모드에서는 디바이스 연결을 가진 primary에서 실행
+    async runRollout(rolloutId) {
+        if (ipc.isWorker) {
+            return ipc.request('firmware:rollout', { rolloutId });
+        }
+
+        const rollout = await database.get('SELECT * FROM firmware_rollouts WHERE id = ?', [rolloutId]);
+        const image = await database.get('SELECT * FROM firmware_images WHERE id = ?', [rollout.image_id]);
+        // 배포 생성 후 삭제된 디바이스는 건너뜀 (JOIN에서 빠져 pending으로 남지 않도록)
+        await database.run(
+            `UPDATE firmware_rollout_devices SET status = 'skipped', error = ?, updated_at = CURRENT_TIMESTAMP
+             WHERE rollout_id = ? AND status = 'pending' AND device_id NOT IN (SELECT id FROM devices)`,
+            ['디바이스를 찾을 수 없습니다.', rolloutId]
+        );
+        const targets = await database.all(
+            `SELECT d.*, r.stage FROM firmware_rollout_devices r
+             JOIN devices d ON d.id = r.device_id
+             WHERE r.rollout_id = ? AND r.status = 'pending'
+             ORDER BY r.stage, d.id`,
+            [rolloutId]
+        );
+
+        await database.run("UPDATE firmware_rollouts SET status = 'running' WHERE id = ?", [rolloutId]);
+        eventHub.publish('firmware-rollout', { rollout_id: rolloutId, status: 'running' });
+
+        const stages = [...new Set(targets.map((target) => target.stage))];
+        let failures = 0;
+        let status = 'completed';
+
+        for (const stage of stages) {
+            const devices = targets.filter((target) => target.stage === stage);
+            logger.info(`펌웨어 배포 ${rolloutId} 단계 ${stage}: ${devices.length}대`);
+
+            const results = await forEachBounded(devices, rollout.concurrency,
+                (device) => this.updateDevice(rolloutId, device, image));
+            failures += results.filter((result) => !result.ok).length;
+
+            if (failures > rollout.max_failures) {
+                status = 'halted';
+                await database.run(
+                    `UPDATE firmware_rollout_devices SET status = 'skipped', updated_at = CURRENT_TIMESTAMP
+                     WHERE rollout_id = ? AND status = 'pending'`,
+                    [rolloutId]
+                );
+                logger.warn(`펌웨어 배포 ${rolloutId} 중단: 실패 ${failures}건`);
+                break;
+            }
+        }
+
+        await database.run(
+            'UPDATE firmware_rollouts SET status = ?, finished_at = CURRENT_TIMESTAMP WHERE id = ?',
+            [status, rolloutId]
+        );
+        eventHub.publish('firmware-rollout', { rollout_id: rolloutId, status, failures });
+    }
+
+    // 서버(primary)가 배포 도중 재시작되면 진행 중이던 배포를 이어갈 수 없으므로 시작 시 중단으로 기록
+    // (전송/재부팅 중이던 디바이스는 failed, 대기 중이던 디바이스는 skipped, 배포는 interrupted)
+    async recoverInterrupted() {
+        if (ipc.isWorker) {
+            return;
+        }
+
+        const rollouts = await database.all(
+            "SELECT id FROM firmware_rollouts WHERE status IN ('pending', 'running')"
+        );
+        for (const { id } of rollouts) {
+            await database.immediateTransaction(async () => {
+                await database.execute(
+                    `UPDATE firmware_rollout_devices SET status = 'failed', error = ?, updated_at = CURRENT_TIMESTAMP
+                     WHERE rollout_id = ? AND status IN ('uploading', 'rebooting')`,
+                    ['서버 재시작으로 중단됨', id]
+                );
+                await database.execute(
+                    `UPDATE firmware_rollout_devices SET status = 'skipped', updated_at = CURRENT_TIMESTAMP
+                     WHERE rollout_id = ? AND status = 'pending'`,
+                    [id]
+                );
+                await database.execute(
+                    "UPDATE firmware_rollouts SET status = 'interrupted', finished_at = CURRENT_TIMESTAMP WHERE id = ?",
+                    [id]
+                );
+            });
+            logger.warn(`펌웨어 배포 ${id}: 서버 재시작으로 중단됨`);
+        }
+    }
+
+    // primary: 워커 요청 처리 등록
+    serve() {
+        ipc.handle('firmware:rollout', ({ rolloutId }) => this.runRollout(rolloutId));
+    }
+}
+
+module.exports = new FirmwareUpdater();
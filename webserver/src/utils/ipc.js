@@ -0,0 +1,156 @@
+const cluster = require('cluster');
+
+// 클러스터 모드(src/cluster.js)의 primary ↔ 워커 메시지 통신
+// - request: 워커 → primary 요청, handle()로 등록한 핸들러의 결과(Promise)를 응답으로 돌려받음
+// - notify: 워커 → primary 단방향 알림
+// - publish: 모든 프로세스에 알림 (워커가 보내면 primary가 다른 워커들에게 다시 전달)
+// 단일 프로세스 모드에서는 아무 메시지도 보내지 않음
+const CHANNEL = 'aircon:ipc';
+
+class Ipc {
+    constructor() {
+        this.handlers = new Map();
+        this.listeners = new Map();
+        this.pending = new Map();
+        this.nextId = 1;
+        this.primary = false;
+
+        if (cluster.isWorker) {
+            process.on('message', (message) => this.onWorkerMessage(message));
+            process.on('disconnect', () => this.rejectPending(new Error('primary 프로세스와 연결이 끊겼습니다.')));
+        }
+    }
+
+    get isWorker() {
+        return cluster.isWorker;
+    }
+
+    get clustered() {
+        return cluster.isWorker || this.primary;
+    }
+
+    // primary: 워커 메시지 수신 시작 (워커 종료는 'worker-exit' 리스너로 전달)
+    serve() {
+        if (this.primary) {
+            return;
+        }
+
+        this.primary = true;
+        cluster.on('message', (worker, message) => this.onPrimaryMessage(worker, message));
+        cluster.on('exit', (worker) => this.emit('worker-exit', worker, worker));
+    }
+
+    handle(type, handler) {
+        this.handlers.set(type, handler);
+    }
+
+    on(type, listener) {
+        if (!this.listeners.has(type)) {
+            this.listeners.set(type, []);
+        }
+        this.listeners.get(type).push(listener);
+    }
+
+    request(type, payload) {
+        return new Promise((resolve, reject) => {
+            const id = this.nextId++;
+            this.pending.set(id, { resolve, reject });
+            process.send({ channel: CHANNEL, kind: 'request', id, type, payload });
+        });
+    }
+
+    notify(type, payload) {
+        if (cluster.isWorker) {
+            process.send({ channel: CHANNEL, kind: 'notify', type, payload });
+        }
+    }
+
+    publish(type, payload) {
+        if (cluster.isWorker) {
+            process.send({ channel: CHANNEL, kind: 'publish', type, payload });
+        } else if (this.primary) {
+            this.broadcast(type, payload);
+        }
+    }
+
+    broadcast(type, payload, except) {
+        for (const worker of Object.values(cluster.workers)) {
+            if (worker && worker !== except && worker.isConnected()) {
+                worker.send({ channel: CHANNEL, kind: 'publish', type, payload });
+            }
+        }
+    }
+
+    emit(type, payload, worker) {
+        for (const listener of this.listeners.get(type) || []) {
+            listener(payload, worker);
+        }
+    }
+
+    async onPrimaryMessage(worker, message) {
+        if (!message || message.channel !== CHANNEL) {
+            return;
+        }
+
+        if (message.kind === 'notify' || message.kind === 'publish') {
+            this.emit(message.type, message.payload, worker);
+            if (message.kind === 'publish') {
+                this.broadcast(message.type, message.payload, worker);
+            }
+            return;
+        }
+
+        if (message.kind !== 'request') {
+            return;
+        }
+
+        const reply = { channel: CHANNEL, kind: 'response', id: message.id };
+        try {
+            const handler = this.handlers.get(message.type);
+            if (!handler) {
+                throw new Error(`처리할 수 없는 IPC 요청: ${message.type}`);
+            }
+            reply.result = await handler(message.payload, worker);
+        } catch (error) {
+            reply.error = { message: error.message, code: error.code };
+        }
+
+        if (worker.isConnected()) {
+            worker.send(reply);
+        }
+    }
+
+    onWorkerMessage(message) {
+        if (!message || message.channel !== CHANNEL) {
+            return;
+        }
+
+        if (message.kind === 'publish') {
+            this.emit(message.type, message.payload);
+            return;
+        }
+
+        const pending = this.pending.get(message.id);
+        if (message.kind !== 'response' || !pending) {
+            return;
+        }
+
+        this.pending.delete(message.id);
+        if (message.error) {
+            const error = new Error(message.error.message);
+            error.code = message.error.code;
+            pending.reject(error);
+        } else {
+            pending.resolve(message.result);
+        }
+    }
+
+    rejectPending(error) {
+        for (const pending of this.pending.values()) {
+            pending.reject(error);
+        }
+        this.pending.clear();
+    }
+}
+
+module.exports = new Ipc();
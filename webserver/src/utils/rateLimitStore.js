@@ -0,0 +1,39 @@
+const sharedStore = require('./sharedStore');
+
+// express-rate-limit 저장소: 카운터를 sharedStore에 두어 클러스터 워커들이 같은 한도를 공유
+// (기본 MemoryStore는 프로세스별이라 워커 수만큼 한도가 늘어남)
+class SharedRateLimitStore {
+    constructor(prefix = 'rate-limit:') {
+        this.prefix = prefix;
+        this.localKeys = false;
+        this.windowMs = 60000;
+    }
+
+    init(options) {
+        this.windowMs = options.windowMs;
+    }
+
+    async get(key) {
+        const counter = await sharedStore.get(this.prefix + key);
+        return counter ? { totalHits: counter.count, resetTime: new Date(counter.resetAt) } : undefined;
+    }
+
+    async increment(key) {
+        const counter = await sharedStore.increment(this.prefix + key, this.windowMs);
+        return { totalHits: counter.count, resetTime: new Date(counter.resetAt) };
+    }
+
+    async decrement(key) {
+        await sharedStore.decrement(this.prefix + key);
+    }
+
+    async resetKey(key) {
+        await sharedStore.delete(this.prefix + key);
+    }
+
+    async resetAll() {
+        await sharedStore.clear(this.prefix);
+    }
+}
+
+module.exports = SharedRateLimitStore;
@@ -0,0 +1,102 @@
+const ipc = require('./ipc');
+
+const SWEEP_INTERVAL_MS = 60000;
+
+// 프로세스 간 공유 카운터 (요청 제한 등)
+// 클러스터 모드에서는 primary가 값을 보관하고 워커는 IPC로 조회/갱신, 단일 프로세스에서는 메모리에 직접 보관
+class SharedStore {
+    constructor() {
+        // key → { count, resetAt }
+        this.counters = new Map();
+        this.sweeper = null;
+    }
+
+    // 고정 윈도 카운터 증가 (윈도가 지났으면 새로 시작)
+    async increment(key, windowMs) {
+        if (ipc.isWorker) {
+            return ipc.request('store:increment', { key, windowMs });
+        }
+
+        const now = Date.now();
+        let counter = this.counters.get(key);
+        if (!counter || counter.resetAt <= now) {
+            counter = { count: 0, resetAt: now + windowMs };
+            this.counters.set(key, counter);
+            this.startSweeper();
+        }
+        counter.count++;
+        return { ...counter };
+    }
+
+    async decrement(key) {
+        if (ipc.isWorker) {
+            return ipc.request('store:decrement', { key });
+        }
+
+        const counter = this.counters.get(key);
+        if (counter && counter.count > 0) {
+            counter.count--;
+        }
+    }
+
+    async get(key) {
+        if (ipc.isWorker) {
+            return ipc.request('store:get', { key });
+        }
+
+        const counter = this.counters.get(key);
+        return counter && counter.resetAt > Date.now() ? { ...counter } : null;
+    }
+
+    async delete(key) {
+        if (ipc.isWorker) {
+            return ipc.request('store:delete', { key });
+        }
+
+        this.counters.delete(key);
+    }
+
+    // prefix로 시작하는 키 전체 삭제
+    async clear(prefix) {
+        if (ipc.isWorker) {
+            return ipc.request('store:clear', { prefix });
+        }
+
+        for (const key of this.counters.keys()) {
+            if (key.startsWith(prefix)) {
+                this.counters.delete(key);
+            }
+        }
+    }
+
+    startSweeper() {
+        if (this.sweeper) {
+            return;
+        }
+
+        this.sweeper = setInterval(() => {
+            const now = Date.now();
+            for (const [key, counter] of this.counters) {
+                if (counter.resetAt <= now) {
+                    this.counters.delete(key);
+                }
+            }
+            if (this.counters.size === 0) {
+                clearInterval(this.sweeper);
+                this.sweeper = null;
+            }
+        }, SWEEP_INTERVAL_MS);
+        this.sweeper.unref();
+    }
+
+    // primary: 워커 요청 처리 등록
+    serve() {
+        ipc.handle('store:increment', ({ key, windowMs }) => this.increment(key, windowMs));
+        ipc.handle('store:decrement', ({ key }) => this.decrement(key));
+        ipc.handle('store:get', ({ key }) => this.get(key));
+        ipc.handle('store:delete', ({ key }) => this.delete(key));
+        ipc.handle('store:clear', ({ prefix }) => this.clear(prefix));
+    }
+}
+
+module.exports = new SharedStore();
@@ -0,0 +1,122 @@
+const database = require('./database');
+const deviceCoordinator = require('./deviceCoordinator');
+const { applyCommand } = require('./commandPlanner');
+
+// IR은 단방향이라 실내기 상태를 읽을 수 없으므로 성공한 명령 기록을 재생해 상태를 추정
+const DEFAULT_STATE = { power: 'off', mode: 'cool', temperature: 24, fan: 1 };
+
+// control_history 행 → 상태 모델 명령
+function historyCommands(row) {
+    let parameters = {};
+    try {
+        parameters = row.parameters ? JSON.parse(row.parameters) : {};
+    } catch (error) {
+        return [];
+    }
+    if (parameters.ok === false) {
+        return [];
+    }
+
+    const count = parameters.count || 1;
+    switch (row.command) {
+        case 'power':
+            return parameters.power ? [[`power_${parameters.power}`, 1]] : [];
+        case 'temp':
+            return parameters.action ? [[`temp_${parameters.action}`, count]] : [];
+        case 'mode':
+            return parameters.mode ? [[`mode_${parameters.mode}`, 1]] : [];
+        case 'fan':
+            return parameters.fan ? [[`fan_${parameters.fan}`, 1]] : [];
+        default:
+            return [];
+    }
+}
+
+class StateModel {
+    constructor() {
+        // deviceId → { state, lastId, updatedAt }
+        this.cache = new Map();
+    }
+
+    // 마지막으로 반영한 기록 이후의 행만 읽어 갱신 (가장 최근 sync 이전 기록은 무시)
+    async get(deviceId) {
+        let entry = this.cache.get(deviceId);
+        if (!entry) {
+            entry = { state: { ...DEFAULT_STATE }, lastId: 0, updatedAt: null, source: 'default' };
+            this.cache.set(deviceId, entry);
+        }
+
+        const rows = await database.all(
+            `SELECT id, command, parameters, executed_at FROM control_history
+             WHERE device_id = ? AND id > ?
+               AND id >= COALESCE((SELECT MAX(id) FROM control_history WHERE device_id = ? AND command = 'sync'), 0)
+             ORDER BY id`,
+            [deviceId, entry.lastId, deviceId]
+        );
+
+        for (const row of rows) {
+            if (row.command === 'sync') {
+                const synced = JSON.parse(row.parameters);
+                entry.state = { ...DEFAULT_STATE, ...synced.state };
+                entry.source = 'sync';
+            } else {
+                for (const [command, count] of historyCommands(row)) {
+                    applyCommand(entry.state, command, count);
+                    entry.source = 'history';
+                }
+            }
+            entry.lastId = row.id;
+            entry.updatedAt = row.executed_at;
+        }
+
+        return { state: { ...entry.state }, source: entry.source, updated_at: entry.updatedAt };
+    }
+
+    // 실제 상태와 어긋났을 때 IR 전송 없이 추정 상태를 교정
+    async sync(deviceId, state, userId) {
+        await database.run(
+            'INSERT INTO control_history (device_id, command, parameters, user_id) VALUES (?, ?, ?, ?)',
+            [deviceId, 'sync', JSON.stringify({ state }), userId]
+        );
+        return this.get(deviceId);
+    }
+
+    // 시퀀스 결과 기록: 전송된 명령은 성공으로, 나머지는 실패로 남김 (spans는 추적 컬럼)
+    async record(deviceId, steps, executed, userId, spans = {}) {
+        const rows = [];
+        let remaining = executed;
+
+        for (const step of steps) {
+            const [command, value] = step.command.split('_');
+            const field = { power: 'power', temp: 'action', mode: 'mode', fan: 'fan' }[command];
+            const fieldValue = command === 'fan' ? parseInt(value, 10) : value;
+            const sent = Math.max(0, Math.min(step.count, remaining));
+            remaining -= sent;
+
+            if (sent > 0) {
+                rows.push({ command, parameters: { [field]: fieldValue, count: sent, ok: true } });
+            }
+            if (sent < step.count) {
+                rows.push({ command, parameters: { [field]: fieldValue, count: step.count - sent, ok: false } });
+            }
+        }
+
+        await database.insertControlHistoryBatch(rows.map((row) => ({
+            device_id: deviceId,
+            command: row.command,
+            parameters: JSON.stringify({ ...row.parameters, sequence: true }),
+            user_id: userId,
+            ...spans
+        })));
+
+        return this.get(deviceId);
+    }
+
+    // 같은 디바이스의 계획→전송→기록을 직렬화 (동시에 계획하면 같은 상태에서 중복 계산됨)
+    // 클러스터 모드에서도 워커 간에 직렬화되도록 deviceCoordinator의 잠금 사용
+    withLock(deviceId, task) {
+        return deviceCoordinator.withLock(deviceId, task);
+    }
+}
+
+module.exports = new StateModel();
@@ -0,0 +1,30 @@
+// 지연 시간 통계 (부하 테스트, 추적 구간 분석 공용)
+
+// 정렬된 배열의 nearest-rank 백분위수
+function percentile(sorted, p) {
+    if (sorted.length === 0) {
+        return null;
+    }
+    const rank = Math.ceil((p / 100) * sorted.length);
+    return round(sorted[Math.max(0, rank - 1)]);
+}
+
+function round(value) {
+    return Math.round(value * 100) / 100;
+}
+
+// null/undefined 값은 제외하고 p50/p95/p99/max/mean 계산
+function summarize(values) {
+    const sorted = values.filter((value) => value !== null && value !== undefined).sort((a, b) => a - b);
+    const sum = sorted.reduce((total, value) => total + value, 0);
+    return {
+        count: sorted.length,
+        p50: percentile(sorted, 50),
+        p95: percentile(sorted, 95),
+        p99: percentile(sorted, 99),
+        max: percentile(sorted, 100),
+        mean: sorted.length ? round(sum / sorted.length) : null
+    };
+}
+
+module.exports = { percentile, round, summarize };
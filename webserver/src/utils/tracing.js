@@ -0,0 +1,45 @@
+const crypto = require('crypto');
+const { round } = require('./stats');
+
+// 펌웨어 REQUEST_ID_MAX(64)보다 짧게 제한
+const REQUEST_ID_PATTERN = /^[\w.:-]{1,48}$/;
+
+// 요청마다 추적 ID 부여 (클라이언트가 보낸 X-Request-ID가 유효하면 그대로 사용)
+function middleware(req, res, next) {
+    const incoming = req.get('X-Request-ID');
+    req.requestId = incoming && REQUEST_ID_PATTERN.test(incoming) ? incoming : crypto.randomUUID();
+    req.startedAt = process.hrtime.bigint();
+    res.set('X-Request-ID', req.requestId);
+    next();
+}
+
+function elapsedMs(startedAt) {
+    return Number(process.hrtime.bigint() - startedAt) / 1e6;
+}
+
+function microsToMs(from, to) {
+    return from && to && to >= from ? round((to - from) / 1000) : null;
+}
+
+// 디바이스 명령 결과를 control_history 구간 컬럼으로 변환
+// - total: 라우트 진입 → 디바이스 응답 수신
+// - server: total 중 디바이스 왕복을 뺀 Node 처리 시간 (DB 조회, 팬아웃 대기 포함)
+// - network: 디바이스 왕복 중 펌웨어 핸들러 밖의 시간 (네트워크 + httpd 대기열)
+// - parse/first_frame/repeat: 펌웨어 핸들러 진입 → IR 전송 시작 → 첫 프레임 → 반복 전송 완료
+function spans(requestId, startedAt, result) {
+    const totalMs = elapsedMs(startedAt);
+    const trace = result.response && result.response.trace;
+    const handlerMs = trace ? microsToMs(trace.received_us, trace.completed_us) : null;
+
+    return {
+        request_id: requestId,
+        span_total_ms: round(totalMs),
+        span_server_ms: round(Math.max(0, totalMs - result.duration_ms)),
+        span_network_ms: handlerMs !== null ? round(Math.max(0, result.duration_ms - handlerMs)) : null,
+        span_parse_ms: trace ? microsToMs(trace.received_us, trace.dispatched_us) : null,
+        span_first_frame_ms: trace ? microsToMs(trace.dispatched_us, trace.first_frame_us) : null,
+        span_repeat_ms: trace ? microsToMs(trace.first_frame_us, trace.completed_us) : null
+    };
+}
+
+module.exports = { middleware, elapsedMs, spans };
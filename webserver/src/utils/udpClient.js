@@ -0,0 +1,154 @@
+const dgram = require('dgram');
+const logger = require('./logger');
+const protocol = require('./udpProtocol');
+
+// ack 상태 → REST 응답 코드 (결과 형식을 HTTP 전송과 맞추기 위함)
+// stale: 이미 처리된 시퀀스인데 응답 캐시가 없음 → 실제 전송 여부 불명
+// busy: 세션을 발급받지 못해 실행되지 않음
+const HTTP_STATUS = { ok: 200, ir_failed: 200, bad_request: 400, stale: 409, busy: 503 };
+
+const RETRY_MS = parseInt(process.env.UDP_RETRY_MS, 10) || 200;
+const RETRY_MAX_MS = 1000;
+const REQUEST_TIMEOUT_MS = parseInt(process.env.DEVICE_REQUEST_TIMEOUT_MS, 10) || 5000;
+// 요청 하나에서 세션 재발급을 받는 최대 횟수 (세션이 계속 정리되는 경우 중단)
+const SESSION_RENEW_MAX = 3;
+
+class UdpClient {
+    constructor() {
+        this.socket = null;
+        // "호스트:포트" → 디바이스가 발급한 세션 ID
+        // 처음에는 세션 0으로 보내고, 디바이스가 재부팅하거나 세션을 정리하면 새 세션을 발급받아 같은 패킷을 다시 보냄
+        this.sessions = new Map();
+        this.sequence = 0;
+        this.pending = new Map();
+    }
+
+    open() {
+        if (this.socket) {
+            return this.socket;
+        }
+
+        this.socket = dgram.createSocket('udp4');
+        this.socket.on('message', (message, remote) => this.handleMessage(message, remote));
+        this.socket.on('error', (error) => logger.error(`UDP 소켓 오류: ${error.message}`));
+        // 대기 중인 요청이 없으면 프로세스 종료를 막지 않음
+        this.socket.unref();
+        return this.socket;
+    }
+
+    close() {
+        if (this.socket) {
+            this.socket.close();
+            this.socket = null;
+        }
+    }
+
+    handleMessage(message, remote) {
+        if (message.length < 16) {
+            return;
+        }
+
+        const entry = this.pending.get(message.readUInt32LE(12));
+        if (!entry || entry.host !== remote.address || entry.port !== remote.port) {
+            return;
+        }
+
+        const ack = protocol.decodeAck(message, entry.key);
+        if (!ack) {
+            return;
+        }
+        if (ack.status === 'session') {
+            this.renewSession(ack.sequence, entry, ack.session);
+            return;
+        }
+        if (ack.session !== entry.session) {
+            return;
+        }
+
+        this.finish(ack.sequence, null, {
+            ...ack,
+            http_status: HTTP_STATUS[ack.status] || 502,
+            attempts: entry.attempts
+        });
+    }
+
+    // 디바이스가 발급한 세션으로 바꿔 즉시 다시 전송 (이전 패킷은 실행되지 않았음)
+    renewSession(sequence, entry, session) {
+        if (++entry.renewals > SESSION_RENEW_MAX) {
+            this.finish(sequence, new Error(`UDP 세션을 발급받지 못함 (${entry.renewals - 1}회 재발급)`));
+            return;
+        }
+
+        this.sessions.set(entry.target, session);
+        entry.session = session;
+        entry.packet = entry.encode(session);
+        clearTimeout(entry.retryTimer);
+        entry.transmit(RETRY_MS);
+    }
+
+    finish(sequence, error, ack) {
+        const entry = this.pending.get(sequence);
+        if (!entry) {
+            return;
+        }
+
+        clearTimeout(entry.retryTimer);
+        clearTimeout(entry.deadline);
+        this.pending.delete(sequence);
+        if (this.pending.size === 0 && this.socket) {
+            this.socket.unref();
+        }
+
+        if (error) {
+            entry.reject(error);
+        } else {
+            entry.resolve(ack);
+        }
+    }
+
+    // 응답(ack)을 받을 때까지 같은 패킷을 재전송 (간격은 RETRY_MAX_MS까지 두 배씩)
+    // 디바이스는 같은 시퀀스 번호를 다시 실행하지 않으므로 재전송해도 IR은 한 번만 나감
+    send(device, steps, options = {}) {
+        const socket = this.open();
+        const sequence = ++this.sequence >>> 0;
+        const host = device.ip_address;
+        const port = device.udp_port || protocol.DEFAULT_PORT;
+        const target = `${host}:${port}`;
+        const timeoutMs = options.timeoutMs || REQUEST_TIMEOUT_MS;
+        const encode = (session) => protocol.encodeCommand(
+            { session, sequence, steps, gapMs: options.gapMs },
+            device.api_key
+        );
+
+        return new Promise((resolve, reject) => {
+            const session = this.sessions.get(target) || 0;
+            const entry = {
+                host, port, target, key: device.api_key, session, encode, packet: encode(session),
+                attempts: 0, renewals: 0, resolve, reject
+            };
+
+            entry.transmit = (delay) => {
+                entry.attempts++;
+                socket.send(entry.packet, port, host, (error) => {
+                    if (error) {
+                        this.finish(sequence, error);
+                    }
+                });
+                entry.retryTimer = setTimeout(() => entry.transmit(Math.min(delay * 2, RETRY_MAX_MS)), delay);
+            };
+
+            entry.deadline = setTimeout(() => {
+                const error = new Error(`UDP 응답 없음 (${entry.attempts}회 전송)`);
+                error.code = 'ETIMEDOUT';
+                this.finish(sequence, error);
+            }, timeoutMs);
+
+            this.pending.set(sequence, entry);
+            socket.ref();
+            entry.transmit(RETRY_MS);
+        });
+    }
+}
+
+module.exports = new UdpClient();
+module.exports.UdpClient = UdpClient;
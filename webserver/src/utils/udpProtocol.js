@@ -0,0 +1,144 @@
+const crypto = require('crypto');
+const { macKey } = require('./deviceAuth');
+
+// 펌웨어 udp_command.h와 같은 고정 레이아웃 (리틀 엔디언)
+// 시뮬레이터도 사용하므로 crypto 외의 의존성 없음
+// MAC 키는 펌웨어 키 저장소와 같이 HMAC-SHA256(API 키, "mac") (deviceAuth.macKey)
+const COMMAND_MAGIC = 0x31554341; // "ACU1"
+const ACK_MAGIC = 0x314B4341;     // "ACK1"
+const VERSION = 2;
+const STEPS_MAX = 8;
+const MAC_LEN = 16;
+const PACKET_SIZE = 48;
+const ACK_SIZE = 64;
+const GAP_MAX_MS = 1000;
+const DEFAULT_PORT = 4210;
+
+// aircon_command_t 순서
+const COMMAND_CODES = [
+    'power_on', 'power_off',
+    'mode_cool', 'mode_heat', 'mode_fan',
+    'temp_up', 'temp_down',
+    'fan_1', 'fan_2', 'fan_3'
+];
+
+// udp_command_status_t 순서
+// session: 디바이스가 모르는 세션이라 실행하지 않음, 응답의 session이 새로 발급된 세션 ID
+// busy: 모르는 세션인데 디바이스의 세션이 모두 사용 중이라 발급받지 못함 (실행하지 않음)
+const STATUS = ['ok', 'ir_failed', 'bad_request', 'stale', 'session', 'busy'];
+
+function computeMac(key, buffer) {
+    return crypto.createHmac('sha256', macKey(key)).update(buffer).digest().subarray(0, MAC_LEN);
+}
+
+function verifyMac(key, buffer) {
+    const expected = computeMac(key, buffer.subarray(0, buffer.length - MAC_LEN));
+    return crypto.timingSafeEqual(expected, buffer.subarray(buffer.length - MAC_LEN));
+}
+
+function seal(key, buffer) {
+    computeMac(key, buffer.subarray(0, buffer.length - MAC_LEN)).copy(buffer, buffer.length - MAC_LEN);
+    return buffer;
+}
+
+// [{ command, count }] 단계가 고정 레이아웃에 들어가는지 확인
+function canEncode(steps) {
+    return Array.isArray(steps) && steps.length >= 1 && steps.length <= STEPS_MAX &&
+        steps.every((step) => {
+            const count = step.count === undefined ? 1 : step.count;
+            return COMMAND_CODES.includes(step.command) && Number.isInteger(count) && count >= 1 && count <= 255;
+        });
+}
+
+function encodeCommand({ session, sequence, steps, gapMs = 0 }, key) {
+    if (!canEncode(steps)) {
+        throw new Error('UDP로 보낼 수 없는 명령 시퀀스입니다.');
+    }
+
+    const buffer = Buffer.alloc(PACKET_SIZE);
+    buffer.writeUInt32LE(COMMAND_MAGIC, 0);
+    buffer.writeUInt8(VERSION, 4);
+    buffer.writeUInt8(steps.length, 5);
+    buffer.writeUInt8(Math.min(Math.round(gapMs / 10), GAP_MAX_MS / 10), 6);
+    buffer.writeUInt32LE(session, 8);
+    buffer.writeUInt32LE(sequence, 12);
+    steps.forEach((step, index) => {
+        buffer.writeUInt8(COMMAND_CODES.indexOf(step.command), 16 + index * 2);
+        buffer.writeUInt8(step.count === undefined ? 1 : step.count, 17 + index * 2);
+    });
+    return seal(key, buffer);
+}
+
+// 형식 또는 MAC이 맞지 않으면 null (펌웨어는 이런 패킷에 응답하지 않음)
+// 명령 번호/반복 횟수 검증은 받는 쪽에서 수행 (잘못된 값은 bad_request 응답)
+function decodeCommand(buffer, key) {
+    if (buffer.length !== PACKET_SIZE || buffer.readUInt32LE(0) !== COMMAND_MAGIC ||
+        buffer.readUInt8(4) !== VERSION || !verifyMac(key, buffer)) {
+        return null;
+    }
+
+    const steps = [];
+    const stepCount = buffer.readUInt8(5);
+    for (let i = 0; i < Math.min(stepCount, STEPS_MAX); i++) {
+        steps.push({ code: buffer.readUInt8(16 + i * 2), count: buffer.readUInt8(17 + i * 2) });
+    }
+
+    return {
+        stepCount,
+        gapMs: buffer.readUInt8(6) * 10,
+        session: buffer.readUInt32LE(8),
+        sequence: buffer.readUInt32LE(12),
+        steps
+    };
+}
+
+function encodeAck({ status, executed = 0, total = 0, session, sequence, trace = {} }, key) {
+    const buffer = Buffer.alloc(ACK_SIZE);
+    buffer.writeUInt32LE(ACK_MAGIC, 0);
+    buffer.writeUInt8(VERSION, 4);
+    buffer.writeUInt8(STATUS.indexOf(status), 5);
+    buffer.writeUInt8(executed, 6);
+    buffer.writeUInt8(total, 7);
+    buffer.writeUInt32LE(session, 8);
+    buffer.writeUInt32LE(sequence, 12);
+    buffer.writeBigInt64LE(BigInt(trace.received_us || 0), 16);
+    buffer.writeBigInt64LE(BigInt(trace.dispatched_us || 0), 24);
+    buffer.writeBigInt64LE(BigInt(trace.first_frame_us || 0), 32);
+    buffer.writeBigInt64LE(BigInt(trace.completed_us || 0), 40);
+    return seal(key, buffer);
+}
+
+function decodeAck(buffer, key) {
+    if (buffer.length !== ACK_SIZE || buffer.readUInt32LE(0) !== ACK_MAGIC ||
+        buffer.readUInt8(4) !== VERSION || !verifyMac(key, buffer)) {
+        return null;
+    }
+
+    return {
+        status: STATUS[buffer.readUInt8(5)] || 'unknown',
+        executed: buffer.readUInt8(6),
+        total: buffer.readUInt8(7),
+        session: buffer.readUInt32LE(8),
+        sequence: buffer.readUInt32LE(12),
+        trace: {
+            received_us: Number(buffer.readBigInt64LE(16)),
+            dispatched_us: Number(buffer.readBigInt64LE(24)),
+            first_frame_us: Number(buffer.readBigInt64LE(32)),
+            completed_us: Number(buffer.readBigInt64LE(40))
+        }
+    };
+}
+
+module.exports = {
+    COMMAND_CODES,
+    STATUS,
+    STEPS_MAX,
+    PACKET_SIZE,
+    ACK_SIZE,
+    DEFAULT_PORT,
+    canEncode,
+    encodeCommand,
+    decodeCommand,
+    encodeAck,
+    decodeAck
+};
@@ -0,0 +1,726 @@
+// ESP32 디바이스 시뮬레이터
+// 사용법: node tools/device-simulator.js [--count 10] [--port 8100] [--latency 20] [--jitter 10]
+//                                        [--airtime 300] [--fail-rate 0] [--drop-rate 0] [--key <API 키>]
+// firmware/main/web_server.c 의 REST API(경로, 인증, 본문 제한, 응답 형식)와
+// udp_command.c 의 UDP 명령 채널(HTTP와 같은 포트 번호), api_auth.c 의 Bearer/서명 인증을 흉내 내며
+// httpd처럼 요청을 디바이스당 하나씩 순서대로 처리한다. 외부 의존성 없음.
+const crypto = require('crypto');
+const dgram = require('dgram');
+const http = require('http');
+const { crc32 } = require('./pack-ir-library');
+const udpProtocol = require('../src/utils/udpProtocol');
+const deviceAuth = require('../src/utils/deviceAuth');
+
+// firmware/main/web_server.c 의 BODY_LIMIT_* 와 같은 값
+const BODY_LIMIT_COMMAND = 256;
+const BODY_LIMIT_CONFIG = 512;
+const BODY_LIMIT_SEQUENCE = 1024;
+const BODY_LIMIT_IR_LIBRARY = 512 * 1024;
+const BODY_LIMIT_OTA = 0x180000;
+
+const IR_LIBRARY_MAGIC = 0x424C5249;
+const IR_LIBRARY_HEADER_SIZE = 40;
+// ir_codes 파티션을 A/B 슬롯으로 나누므로 최대 크기는 절반에서 커밋 표시(8바이트)를 뺀 값
+const IR_LIBRARY_PARTITION_SIZE = 0x80000;
+const IR_LIBRARY_MAX_SIZE = IR_LIBRARY_PARTITION_SIZE / 2 - 8;
+const TEMP_MIN = 18;
+const TEMP_MAX = 30;
+// ir_controller.c 의 DEFAULT_REPEAT (첫 프레임은 airtime의 1/3 시점)
+const IR_REPEAT = 3;
+// firmware/main/ir_controller.h 의 IR_SEQUENCE_MAX, ir_controller.c 의 command_names
+const SEQUENCE_MAX = 32;
+// udp_command.c 의 UDP_SESSION_MAX, UDP_ACK_CACHE, UDP_SESSION_IDLE_US, UDP_GAP_MAX_10MS
+const UDP_SESSION_MAX = 4;
+const UDP_ACK_CACHE = 4;
+const UDP_SESSION_IDLE_US = 60 * 1000 * 1000;
+const UDP_GAP_MAX_MS = 1000;
+const SEQUENCE_COMMANDS = [
+    'power_on', 'power_off', 'mode_cool', 'mode_heat', 'mode_fan',
+    'temp_up', 'temp_down', 'fan_1', 'fan_2', 'fan_3'
+];
+
+const DEFAULTS = {
+    host: '127.0.0.1',
+    port: 0,
+    apiKey: 'aircon_control_2024',
+    apiKeyId: 'default',  // 서명 요청의 키 ID (시뮬레이터 키는 모든 권한)
+    latencyMs: 0,       // 왕복 네트워크 지연 (요청 처리 전에 적용)
+    jitterMs: 0,
+    airtimeMs: 300,     // IR 송신 시간 (전원/온도/모드 명령)
+    failRate: 0,        // IR 송신 실패 비율 ({"status": "error"} 응답)
+    dropRate: 0,        // 응답 없이 연결을 끊는 비율
+    rebootMs: 3000      // OTA 완료 후 재부팅에 걸리는 시간
+};
+
+class HttpError extends Error {
+    constructor(status, message) {
+        super(message);
+        this.status = status;
+    }
+}
+
+class SimulatedDevice {
+    constructor(options = {}) {
+        this.options = { ...DEFAULTS, ...options };
+        this.server = null;
+        this.udp = null;
+        this.udpSessions = new Map();
+        this.queue = Promise.resolve();
+        this.offline = false;
+
+        this.state = { power: 'off', mode: 'cool', temperature: 24, fan: 1 };
+        this.wifiSsid = 'simulator';
+        this.model = { brand: 'LG', model: 'default' };
+        this.library = null;
+        this.firmware = { version: '1.0.0', running: 'ota_0', pendingVerify: false };
+        this.ota = null;
+        // 부팅마다 바뀌는 ID와 마지막 서명 요청 nonce (api_auth.c)
+        this.bootId = crypto.randomBytes(4).toString('hex');
+        this.lastNonce = 0n;
+        this.authStats = {
+            bearer: { count: 0, failed: 0, total_us: 0, max_us: 0 },
+            hmac: { count: 0, failed: 0, total_us: 0, max_us: 0 }
+        };
+
+        this.stats = {
+            requests: 0, commands: 0, ir_failures: 0, dropped: 0, unauthorized: 0, rejected: 0,
+            udp_packets: 0, udp_retransmits: 0
+        };
+
+        this.routes = {
+            'GET /api/status': () => this.handleStatus(),
+            'GET /api/wifi': () => ({ status: 'connected', ssid: this.wifiSsid }),
+            'POST /api/aircon/power': (req, body) => this.handleCommand(req, body, 'power', ['on', 'off'],
+                '명령이 성공적으로 전송되었습니다'),
+            'POST /api/aircon/temp': (req, body) => this.handleCommand(req, body, 'action', ['up', 'down'],
+                '온도 조정 명령이 전송되었습니다'),
+            'POST /api/aircon/mode': (req, body) => this.handleCommand(req, body, 'mode', ['cool', 'heat', 'fan'],
+                '모드 변경 명령이 전송되었습니다'),
+            'POST /api/aircon/sequence': (req, body) => this.handleSequence(req, body),
+            'POST /api/config/wifi': (req, body) => this.handleWifiConfig(body),
+            'GET /api/config': () => ({ wifi_ssid: this.wifiSsid, wifi_password: '***' }),
+            'GET /api/ir/library': () => this.handleLibraryInfo(),
+            'POST /api/ir/library': (req, body) => this.handleLibraryUpload(body),
+            'POST /api/ir/model': (req, body) => this.handleModel(body),
+            'GET /api/ota': () => this.otaStatus(),
+            'POST /api/ota': (req, body) => this.handleOta(req, body),
+            'POST /api/ota/abort': () => {
+                this.ota = null;
+                return { status: 'success' };
+            },
+            'GET /api/auth': () => this.handleAuthInfo()
+        };
+
+        this.bodyLimits = {
+            '/api/aircon/power': BODY_LIMIT_COMMAND,
+            '/api/aircon/temp': BODY_LIMIT_COMMAND,
+            '/api/aircon/mode': BODY_LIMIT_COMMAND,
+            '/api/aircon/sequence': BODY_LIMIT_SEQUENCE,
+            '/api/ir/model': BODY_LIMIT_COMMAND,
+            '/api/config/wifi': BODY_LIMIT_CONFIG,
+            '/api/ir/library': BODY_LIMIT_IR_LIBRARY,
+            '/api/ota': BODY_LIMIT_OTA
+        };
+    }
+
+    get port() {
+        return this.server ? this.server.address().port : null;
+    }
+
+    async start() {
+        this.server = http.createServer((req, res) => this.onRequest(req, res));
+        this.server.keepAliveTimeout = 5000;
+
+        await new Promise((resolve, reject) => {
+            this.server.once('error', reject);
+            this.server.listen(this.options.port, this.options.host, resolve);
+        });
+
+        this.udp = dgram.createSocket('udp4');
+        this.udp.on('message', (message, remote) => this.onPacket(message, remote));
+        await new Promise((resolve, reject) => {
+            this.udp.once('error', reject);
+            this.udp.bind(this.port, this.options.host, resolve);
+        });
+        return this;
+    }
+
+    stop() {
+        if (this.udp) {
+            this.udp.close();
+            this.udp = null;
+        }
+        return new Promise((resolve) => {
+            if (!this.server) {
+                return resolve();
+            }
+            this.server.close(() => resolve());
+            this.server.closeAllConnections();
+        });
+    }
+
+    // esp_timer_get_time 처럼 마이크로초 단위 단조 시각
+    nowUs() {
+        return Number(process.hrtime.bigint() / 1000n);
+    }
+
+    delay(ms) {
+        return new Promise((resolve) => setTimeout(resolve, ms));
+    }
+
+    networkDelay() {
+        const { latencyMs, jitterMs } = this.options;
+        return latencyMs + Math.random() * jitterMs;
+    }
+
+    onRequest(req, res) {
+        if (this.offline) {
+            req.socket.destroy();
+            return;
+        }
+
+        this.stats.requests++;
+        const url = new URL(req.url, 'http://device');
+        const limit = this.bodyLimits[url.pathname] || BODY_LIMIT_COMMAND;
+        const declared = parseInt(req.headers['content-length'], 10) || 0;
+
+        // 펌웨어는 Content-Length만 보고 본문을 읽기 전에 413으로 거절
+        if (declared > limit) {
+            this.stats.rejected++;
+            return this.send(res, 413, null);
+        }
+
+        const chunks = [];
+        req.on('data', (chunk) => chunks.push(chunk));
+        req.on('end', () => {
+            const body = Buffer.concat(chunks);
+
+            // httpd는 단일 태스크이므로 요청을 순서대로 처리
+            this.queue = this.queue
+                .then(() => this.delay(this.networkDelay()))
+                .then(() => this.dispatch(req, res, url, body))
+                .catch(() => {});
+        });
+    }
+
+    async dispatch(req, res, url, body) {
+        // 펌웨어 trace_begin: 핸들러 진입 시각과 X-Request-ID
+        req.trace = { received_us: this.nowUs() };
+        const requestId = req.headers['x-request-id'];
+        if (requestId) {
+            req.trace.request_id = requestId.slice(0, 63);
+            res.setHeader('X-Request-ID', req.trace.request_id);
+        }
+
+        if (Math.random() < this.options.dropRate) {
+            this.stats.dropped++;
+            req.socket.destroy();
+            return;
+        }
+
+        const route = this.routes[`${req.method} ${url.pathname}`];
+        if (!route) {
+            return this.send(res, 404, null);
+        }
+
+        if (!this.authenticate(req)) {
+            this.stats.unauthorized++;
+            res.setHeader('WWW-Authenticate', `HMAC boot=${this.bootId}`);
+            return this.send(res, 401, null);
+        }
+
+        // http_body: 서명 요청은 받은 본문의 해시가 서명된 X-Content-SHA256과 같아야 처리
+        if (req.contentSha256 && deviceAuth.contentHash(body) !== req.contentSha256) {
+            this.stats.rejected++;
+            return this.send(res, 400, { status: 'error', message: '본문 해시 불일치' });
+        }
+
+        try {
+            const result = await route(req, body);
+            const status = result && result.httpStatus ? result.httpStatus : 200;
+            if (result) {
+                delete result.httpStatus;
+            }
+            this.send(res, status, result);
+        } catch (error) {
+            if (!(error instanceof HttpError)) {
+                throw error;
+            }
+            this.stats.rejected++;
+            this.send(res, error.status, error.message || null);
+        }
+    }
+
+    // api_auth_verify: Bearer는 해시 상수 시간 비교, 서명은 부팅 ID와 증가하는 nonce 확인
+    authenticate(req) {
+        const header = req.headers.authorization || '';
+        const mode = header.startsWith('Bearer ') ? 'bearer' : (header.startsWith('HMAC ') ? 'hmac' : null);
+        if (!mode) {
+            return false;
+        }
+
+        const startedAt = process.hrtime.bigint();
+        let ok;
+        if (mode === 'bearer') {
+            const hash = crypto.createHash('sha256').update(header.slice(7)).digest();
+            ok = deviceAuth.constantTimeEqual(hash, deviceAuth.keyHash(this.options.apiKey));
+        } else {
+            const signed = deviceAuth.parseSigned(header);
+            const bound = {
+                contentSha256: req.headers['x-content-sha256'],
+                imageSha256: req.headers['x-image-sha256'],
+                contentRange: req.headers['content-range']
+            };
+            ok = Boolean(signed) && signed.keyId === this.options.apiKeyId &&
+                /^[0-9a-f]{64}$/.test(bound.contentSha256 || '') &&
+                deviceAuth.verifySignature(this.options.apiKey, req.method, req.url, this.bootId, signed, bound) &&
+                signed.nonce > this.lastNonce;
+            if (ok) {
+                this.lastNonce = signed.nonce;
+                req.contentSha256 = bound.contentSha256;
+            }
+        }
+
+        const elapsedUs = Number(process.hrtime.bigint() - startedAt) / 1000;
+        const stats = this.authStats[mode];
+        stats.count++;
+        stats.total_us += elapsedUs;
+        stats.max_us = Math.max(stats.max_us, elapsedUs);
+        if (!ok) {
+            stats.failed++;
+        }
+        return ok;
+    }
+
+    handleAuthInfo() {
+        const stats = {};
+        for (const [mode, { count, failed, total_us: totalUs, max_us: maxUs }] of Object.entries(this.authStats)) {
+            stats[mode] = { count, failed, mean_us: count ? totalUs / count : 0, max_us: maxUs };
+        }
+        return {
+            boot_id: this.bootId,
+            keys: [{ id: this.options.apiKeyId, scopes: deviceAuth.SCOPES, hmac_only: false, legacy: false }],
+            stats
+        };
+    }
+
+    // UDP 명령 패킷 (udp_command_task와 같은 순서: 형식/MAC 검증 → 재전송 확인 → 실행)
+    onPacket(message, remote) {
+        if (this.offline) {
+            return;
+        }
+        this.stats.udp_packets++;
+
+        this.queue = this.queue
+            .then(() => this.delay(this.networkDelay()))
+            .then(() => this.dispatchPacket(message, remote))
+            .catch(() => {});
+    }
+
+    async dispatchPacket(message, remote) {
+        const receivedUs = this.nowUs();
+        if (Math.random() < this.options.dropRate) {
+            this.stats.dropped++;
+            return;
+        }
+
+        // 형식이 맞지 않거나 인증에 실패한 패킷은 응답 없이 버림
+        const packet = udpProtocol.decodeCommand(message, this.options.apiKey);
+        if (!packet) {
+            this.stats.unauthorized++;
+            return;
+        }
+
+        const reply = (ack) => {
+            if (this.udp) {
+                this.udp.send(ack, remote.port, remote.address);
+            }
+        };
+
+        // 모르는 세션은 실행하지 않고 새 세션 발급 (모든 세션이 사용 중이면 busy)
+        const session = this.udpSessions.get(packet.session);
+        if (!session) {
+            const issued = this.issueUdpSession(`${remote.address}:${remote.port}`, receivedUs);
+            reply(udpProtocol.encodeAck(issued
+                ? { status: 'session', ...packet, session: issued }
+                : { status: 'busy', ...packet }, this.options.apiKey));
+            return;
+        }
+        // Map 순서를 최근 사용 순으로 유지
+        session.lastSeenUs = receivedUs;
+        this.udpSessions.delete(packet.session);
+        this.udpSessions.set(packet.session, session);
+
+        if (packet.sequence <= session.lastSequence) {
+            this.stats.udp_retransmits++;
+            reply(session.acks.get(packet.sequence) ||
+                udpProtocol.encodeAck({ status: 'stale', ...packet }, this.options.apiKey));
+            return;
+        }
+        session.lastSequence = packet.sequence;
+
+        const ack = udpProtocol.encodeAck(await this.executePacket(packet, receivedUs), this.options.apiKey);
+        session.acks.set(packet.sequence, ack);
+        if (session.acks.size > UDP_ACK_CACHE) {
+            session.acks.delete(session.acks.keys().next().value);
+        }
+        reply(ack);
+    }
+
+    // issue_session과 같은 규칙: 같은 주소의 미사용 세션은 다시 알려주고,
+    // 최근 UDP_SESSION_IDLE_US 안에 쓰인 세션은 밀어내지 않음 (자리가 없으면 null)
+    issueUdpSession(source, nowUs) {
+        let idle = null;
+        for (const [id, session] of this.udpSessions) {
+            if (session.lastSequence === 0 && session.source === source) {
+                return id;
+            }
+            if (idle === null && nowUs - session.lastSeenUs >= UDP_SESSION_IDLE_US) {
+                idle = id;
+            }
+        }
+        if (this.udpSessions.size >= UDP_SESSION_MAX) {
+            if (idle === null) {
+                return null;
+            }
+            this.udpSessions.delete(idle);
+        }
+
+        let id;
+        do {
+            id = crypto.randomBytes(4).readUInt32LE(0);
+        } while (id === 0 || this.udpSessions.has(id));
+        this.udpSessions.set(id, { source, lastSeenUs: nowUs, lastSequence: 0, acks: new Map() });
+        return id;
+    }
+
+    async executePacket(packet, receivedUs) {
+        const trace = { received_us: receivedUs };
+        const result = { session: packet.session, sequence: packet.sequence, trace };
+        const commands = [];
+        const valid = packet.stepCount >= 1 && packet.stepCount <= udpProtocol.STEPS_MAX &&
+            packet.gapMs <= UDP_GAP_MAX_MS &&
+            packet.steps.every((step) => {
+                if (step.code >= udpProtocol.COMMAND_CODES.length || step.count < 1 ||
+                    commands.length + step.count > SEQUENCE_MAX) {
+                    return false;
+                }
+                for (let i = 0; i < step.count; i++) {
+                    commands.push(udpProtocol.COMMAND_CODES[step.code]);
+                }
+                return true;
+            });
+
+        if (!valid) {
+            this.stats.rejected++;
+            return { ...result, status: 'bad_request' };
+        }
+
+        let executed = 0;
+        for (const command of commands) {
+            if (executed > 0) {
+                await this.delay(packet.gapMs);
+            }
+            if (!(await this.emit(command, trace))) {
+                return { ...result, status: 'ir_failed', executed, total: commands.length };
+            }
+            executed++;
+        }
+        return { ...result, status: 'ok', executed, total: commands.length };
+    }
+
+    send(res, status, body) {
+        if (res.destroyed) {
+            return;
+        }
+        if (body === null) {
+            res.writeHead(status);
+            res.end();
+        } else if (typeof body === 'string') {
+            // httpd_resp_send_err 는 text/html 본문으로 메시지를 보냄
+            res.writeHead(status, { 'Content-Type': 'text/html' });
+            res.end(body);
+        } else {
+            res.writeHead(status, { 'Content-Type': 'application/json' });
+            res.end(JSON.stringify(body, null, '\t'));
+        }
+    }
+
+    parseJson(body) {
+        if (body.length === 0) {
+            throw new HttpError(400, '요청 본문이 비어 있습니다');
+        }
+        try {
+            const json = JSON.parse(body.toString('utf8'));
+            if (json && typeof json === 'object') {
+                return json;
+            }
+        } catch (error) {
+            // 아래에서 400 응답
+        }
+        throw new HttpError(400, '잘못된 JSON 형식');
+    }
+
+    handleStatus() {
+        return {
+            status: 'online',
+            device: 'ESP32 Aircon Controller',
+            version: this.firmware.version,
+            wifi_ssid: this.wifiSsid,
+            wifi_status: 'connected',
+            // 시뮬레이터 전용: 마지막으로 수신한 IR 명령 기준의 에어컨 상태
+            simulator: { ...this.state }
+        };
+    }
+
+    async handleCommand(req, body, field, values, successMessage) {
+        const json = this.parseJson(body);
+        const value = json[field];
+        if (typeof value !== 'string' || !values.includes(value)) {
+            throw new HttpError(400, '잘못된 요청 파라미터');
+        }
+
+        const command = field === 'action' ? `temp_${value}` : `${field}_${value}`;
+        if (!(await this.emit(command, req.trace))) {
+            return { status: 'error', message: '명령 전송 실패', trace: req.trace };
+        }
+        return { status: 'success', message: successMessage, trace: req.trace };
+    }
+
+    async handleSequence(req, body) {
+        const json = this.parseJson(body);
+        const commands = [];
+        const valid = Array.isArray(json.steps) && json.steps.every((step) => {
+            const times = step && step.count !== undefined ? step.count : 1;
+            if (!step || !SEQUENCE_COMMANDS.includes(step.command) || !Number.isInteger(times) || times < 1 ||
+                commands.length + times > SEQUENCE_MAX) {
+                return false;
+            }
+            for (let i = 0; i < times; i++) {
+                commands.push(step.command);
+            }
+            return true;
+        });
+        const gapMs = Number.isInteger(json.gap_ms) && json.gap_ms > 0 ? json.gap_ms : 0;
+        if (!valid || commands.length === 0 || gapMs > 1000) {
+            throw new HttpError(400, '잘못된 요청 파라미터');
+        }
+
+        let executed = 0;
+        for (const command of commands) {
+            if (executed > 0) {
+                await this.delay(gapMs);
+            }
+            if (!(await this.emit(command, req.trace))) {
+                return { status: 'error', message: '명령 전송 실패', executed, total: commands.length, trace: req.trace };
+            }
+            executed++;
+        }
+        return {
+            status: 'success',
+            message: '명령 시퀀스가 전송되었습니다',
+            executed,
+            total: commands.length,
+            trace: req.trace
+        };
+    }
+
+    // IR 명령 하나 송신 (airtime 대기 후 실패 주입, 성공 시 에어컨 상태 반영)
+    async emit(command, trace) {
+        this.stats.commands++;
+        trace.dispatched_us = trace.dispatched_us || this.nowUs();
+        await this.delay(this.options.airtimeMs / IR_REPEAT);
+        trace.first_frame_us = trace.first_frame_us || this.nowUs();
+        await this.delay(this.options.airtimeMs - this.options.airtimeMs / IR_REPEAT);
+        trace.completed_us = this.nowUs();
+
+        if (Math.random() < this.options.failRate) {
+            this.stats.ir_failures++;
+            return false;
+        }
+
+        // 전원이 꺼져 있으면 전원 외 명령은 무시하고, 송풍 모드에서는 온도 명령을 무시 (commandPlanner와 같은 규칙)
+        const [kind, value] = command.split('_');
+        if (kind === 'power') {
+            this.state.power = value;
+        } else if (this.state.power !== 'on') {
+            return true;
+        } else if (kind === 'mode') {
+            this.state.mode = value;
+        } else if (kind === 'fan') {
+            this.state.fan = Number(value);
+        } else if (this.state.mode !== 'fan') {
+            const step = value === 'up' ? 1 : -1;
+            this.state.temperature = Math.min(TEMP_MAX, Math.max(TEMP_MIN, this.state.temperature + step));
+        }
+        return true;
+    }
+
+    handleWifiConfig(body) {
+        const json = this.parseJson(body);
+        if (typeof json.ssid !== 'string' || typeof json.password !== 'string') {
+            throw new HttpError(400, '잘못된 요청 파라미터');
+        }
+        this.wifiSsid = json.ssid;
+        return { status: 'success', message: 'WiFi 설정이 저장되었습니다' };
+    }
+
+    handleLibraryInfo() {
+        const info = this.library
+            ? { ...this.library, partition_size: IR_LIBRARY_PARTITION_SIZE, max_size: IR_LIBRARY_MAX_SIZE }
+            : { error: 'IR 코드 파티션 없음' };
+        return { ...info, ...this.model };
+    }
+
+    handleLibraryUpload(body) {
+        if (body.length > IR_LIBRARY_MAX_SIZE) {
+            throw new HttpError(413, null);
+        }
+        const valid = body.length >= IR_LIBRARY_HEADER_SIZE &&
+            body.readUInt32LE(0) === IR_LIBRARY_MAGIC &&
+            body.readUInt32LE(32) === body.length &&
+            body.readUInt32LE(36) === crc32(body.subarray(IR_LIBRARY_HEADER_SIZE));
+
+        if (!valid) {
+            return { status: 'error', message: '라이브러리 검증 실패' };
+        }
+
+        this.library = { models: body.readUInt32LE(8), codes: body.readUInt32LE(16), size: body.length };
+        return { status: 'success', models: this.library.models, codes: this.library.codes };
+    }
+
+    handleModel(body) {
+        const json = this.parseJson(body);
+        if (typeof json.brand !== 'string' || typeof json.model !== 'string') {
+            throw new HttpError(400, '잘못된 요청 파라미터');
+        }
+        // 라이브러리 내용은 해석하지 않으므로 라이브러리가 있으면 모든 모델을 허용
+        if (!this.library && !(json.brand === 'LG' && json.model === 'default')) {
+            return { status: 'error', message: '라이브러리에 없는 모델입니다' };
+        }
+        this.model = { brand: json.brand, model: json.model };
+        return { status: 'success', message: '모델이 선택되었습니다' };
+    }
+
+    otaStatus() {
+        const target = this.firmware.running === 'ota_0' ? 'ota_1' : 'ota_0';
+        return {
+            version: this.firmware.version,
+            running_partition: this.firmware.running,
+            target_partition: target,
+            pending_verify: this.firmware.pendingVerify,
+            active: Boolean(this.ota),
+            image_size: this.ota ? this.ota.size : 0,
+            received: this.ota ? this.ota.received : 0,
+            sha256: this.ota ? this.ota.sha256 : ''
+        };
+    }
+
+    handleOta(req, body) {
+        const sha256 = (req.headers['x-image-sha256'] || '').toLowerCase();
+        if (!/^[0-9a-f]{64}$/.test(sha256)) {
+            throw new HttpError(400, 'X-Image-SHA256 헤더가 필요합니다');
+        }
+
+        let start = 0;
+        let total = body.length;
+        const range = req.headers['content-range'];
+        if (range) {
+            const match = /^bytes (\d+)-(\d+)\/(\d+)$/.exec(range);
+            if (!match || Number(match[2]) < Number(match[1]) ||
+                Number(match[2]) - Number(match[1]) + 1 !== body.length) {
+                throw new HttpError(400, '잘못된 Content-Range');
+            }
+            start = Number(match[1]);
+            total = Number(match[3]);
+        }
+
+        if (total > BODY_LIMIT_OTA) {
+            throw new HttpError(413, null);
+        }
+        if (!this.ota || this.ota.sha256 !== sha256 || this.ota.size !== total) {
+            this.ota = { sha256, size: total, received: 0, chunks: [] };
+        }
+
+        if (start !== this.ota.received) {
+            return { httpStatus: 409, status: 'error', message: '재개 위치 불일치', ...this.otaStatus() };
+        }
+
+        this.ota.chunks.push(body);
+        this.ota.received += body.length;
+        if (this.ota.received < total) {
+            return { httpStatus: 202, status: 'partial', ...this.otaStatus() };
+        }
+
+        const digest = crypto.createHash('sha256').update(Buffer.concat(this.ota.chunks)).digest('hex');
+        if (digest !== sha256) {
+            this.ota = null;
+            return { httpStatus: 422, status: 'error', message: 'SHA-256 불일치', ...this.otaStatus() };
+        }
+
+        this.ota = null;
+        const response = { status: 'success', message: '업데이트 완료, 재부팅합니다', ...this.otaStatus() };
+        setTimeout(() => this.reboot(response.target_partition, digest), 1000);
+        return response;
+    }
+
+    // 재부팅 동안 연결을 받지 않다가 새 파티션으로 부팅 (부팅 확인은 바로 완료)
+    reboot(partition, digest) {
+        this.offline = true;
+        this.server.closeAllConnections();
+        setTimeout(() => {
+            this.firmware = { version: `sim-${digest.slice(0, 8)}`, running: partition, pendingVerify: false };
+            this.bootId = crypto.randomBytes(4).toString('hex');
+            this.lastNonce = 0n;
+            this.offline = false;
+        }, this.options.rebootMs);
+    }
+}
+
+// 연속된 포트(basePort가 0이면 임의 포트)에 시뮬레이터 여러 대 시작
+async function startDevices(count, options = {}) {
+    const devices = [];
+    for (let i = 0; i < count; i++) {
+        const port = options.port ? options.port + i : 0;
+        devices.push(await new SimulatedDevice({ ...options, port }).start());
+    }
+    return devices;
+}
+
+async function main() {
+    const args = process.argv.slice(2);
+    const option = (name, fallback) => {
+        const index = args.indexOf(name);
+        return index >= 0 ? Number(args[index + 1]) : fallback;
+    };
+    const keyIndex = args.indexOf('--key');
+
+    const count = option('--count', 1);
+    const devices = await startDevices(count, {
+        port: option('--port', 8100),
+        latencyMs: option('--latency', DEFAULTS.latencyMs),
+        jitterMs: option('--jitter', DEFAULTS.jitterMs),
+        airtimeMs: option('--airtime', DEFAULTS.airtimeMs),
+        failRate: option('--fail-rate', DEFAULTS.failRate),
+        dropRate: option('--drop-rate', DEFAULTS.dropRate),
+        apiKey: keyIndex >= 0 ? args[keyIndex + 1] : (process.env.DEFAULT_ESP32_API_KEY || DEFAULTS.apiKey)
+    });
+
+    console.log(`시뮬레이터 ${count}대 실행 중: ${DEFAULTS.host}:${devices[0].port}-${devices[count - 1].port}`);
+
+    process.on('SIGINT', async () => {
+        await Promise.all(devices.map((device) => device.stop()));
+        const stats = devices.map((device) => ({ port: device.port, ...device.stats }));
+        console.log(JSON.stringify({ simulator: stats }, null, 2));
+        process.exit(0);
+    });
+}
+
+if (require.main === module) {
+    main().catch((error) => {
+        console.error(error.message);
+        process.exit(1);
+    });
+}
+
+module.exports = { SimulatedDevice, startDevices };
@@ -0,0 +1,211 @@
+// 종단 간 부하 테스트
+// 사용법: node tools/load-test.js [--server http://localhost:3000] [--devices 10] [--concurrency 8] [--duration 30]
+//                                 [--latency 20] [--jitter 10] [--airtime 300] [--fail-rate 0] [--drop-rate 0]
+//                                 [--out results.json]
+// 시뮬레이터 N대를 띄워 서버 DB에 등록하고, 실행 중인 Node 서버의 명령 API를 폐루프(closed-loop)로 호출해
+// 명령 지연(p50/p95/p99), 처리량, 에러율을 JSON으로 출력한다.
+// 서버와 같은 DB 파일을 사용하므로 서버와 같은 머신에서 실행하고, 서버의 RATE_LIMIT_MAX를 충분히 올려야 한다.
+const fs = require('fs');
+const http = require('http');
+const database = require('../src/utils/database');
+const { summarize } = require('../src/utils/stats');
+const { startDevices } = require('./device-simulator');
+
+const NAME_PREFIX = 'loadtest-';
+const API_KEY = 'loadtest_key';
+const PAYLOADS = [
+    { power: 'on' },
+    { power: 'off' },
+    { action: 'up' },
+    { action: 'down' },
+    { mode: 'cool' },
+    { mode: 'heat' },
+    { mode: 'fan' }
+];
+
+function parseArgs(argv) {
+    const args = argv.slice(2);
+    const value = (name, fallback) => {
+        const index = args.indexOf(name);
+        return index >= 0 ? args[index + 1] : fallback;
+    };
+
+    return {
+        server: value('--server', `http://localhost:${process.env.PORT || 3000}`),
+        devices: Number(value('--devices', 10)),
+        concurrency: Number(value('--concurrency', 8)),
+        durationMs: Number(value('--duration', 30)) * 1000,
+        out: value('--out', null),
+        simulator: {
+            apiKey: API_KEY,
+            latencyMs: Number(value('--latency', 20)),
+            jitterMs: Number(value('--jitter', 10)),
+            airtimeMs: Number(value('--airtime', 300)),
+            failRate: Number(value('--fail-rate', 0)),
+            dropRate: Number(value('--drop-rate', 0))
+        }
+    };
+}
+
+// 이전 실행이 중단되어 남은 데이터까지 정리
+async function cleanup() {
+    const devices = await database.all('SELECT id FROM devices WHERE name LIKE ?', [`${NAME_PREFIX}%`]);
+    const ids = devices.map((device) => device.id);
+    if (ids.length > 0) {
+        const placeholders = ids.map(() => '?').join(', ');
+        await database.run(`DELETE FROM control_history WHERE device_id IN (${placeholders})`, ids);
+        await database.run(`DELETE FROM device_group_members WHERE device_id IN (${placeholders})`, ids);
+        await database.run(`DELETE FROM devices WHERE id IN (${placeholders})`, ids);
+    }
+    await database.run('DELETE FROM device_groups WHERE name LIKE ?', [`${NAME_PREFIX}%`]);
+}
+
+// 시뮬레이터마다 디바이스와 단일 멤버 그룹을 등록 (그룹 명령 API로 디바이스를 하나씩 지정)
+async function seed(simulators) {
+    const groupIds = [];
+    for (const [index, simulator] of simulators.entries()) {
+        const name = `${NAME_PREFIX}${index + 1}`;
+        const device = await database.run(
+            `INSERT INTO devices (name, ip_address, port, api_key, status) VALUES (?, ?, ?, ?, 'online')`,
+            [name, '127.0.0.1', simulator.port, API_KEY]
+        );
+        const group = await database.run(
+            'INSERT INTO device_groups (name, description) VALUES (?, ?)',
+            [name, '부하 테스트용 임시 그룹']
+        );
+        await database.run(
+            'INSERT INTO device_group_members (group_id, device_id) VALUES (?, ?)',
+            [group.id, device.id]
+        );
+        groupIds.push(group.id);
+    }
+    return groupIds;
+}
+
+// 명령 하나를 보내고 NDJSON 스트림의 done 이벤트까지 기다림
+function sendCommand(agent, server, groupId, payload) {
+    const url = new URL(`/api/groups/${groupId}/command`, server);
+    const body = JSON.stringify(payload);
+    const startedAt = process.hrtime.bigint();
+
+    return new Promise((resolve) => {
+        const finish = (fields) => resolve({
+            latency_ms: Number(process.hrtime.bigint() - startedAt) / 1e6,
+            ...fields
+        });
+
+        const req = http.request(url, {
+            method: 'POST',
+            agent,
+            headers: {
+                'Content-Type': 'application/json',
+                'Content-Length': Buffer.byteLength(body),
+                'Accept': 'application/x-ndjson'
+            }
+        }, (res) => {
+            let text = '';
+            res.setEncoding('utf8');
+            res.on('data', (chunk) => { text += chunk; });
+            res.on('end', () => {
+                if (res.statusCode !== 200) {
+                    return finish({ ok: false, error: `HTTP ${res.statusCode}` });
+                }
+
+                const events = text.split('\n').filter(Boolean).map((line) => JSON.parse(line));
+                const result = events.find((event) => event.event === 'result');
+                const done = events.find((event) => event.event === 'done');
+                if (!done || !result) {
+                    return finish({ ok: false, error: 'incomplete stream' });
+                }
+                finish({
+                    ok: result.ok,
+                    device_ms: result.duration_ms,
+                    ...(result.ok ? {} : { error: `device: ${result.error}` })
+                });
+            });
+        });
+
+        req.on('error', (error) => finish({ ok: false, error: error.code || error.message }));
+        req.end(body);
+    });
+}
+
+async function run() {
+    const config = parseArgs(process.argv);
+
+    await database.initialize();
+    await cleanup();
+
+    const simulators = await startDevices(config.devices, config.simulator);
+    const groupIds = await seed(simulators);
+    const agent = new http.Agent({ keepAlive: true, maxSockets: config.concurrency });
+
+    const samples = [];
+    const startedAt = Date.now();
+    const deadline = startedAt + config.durationMs;
+
+    // 각 가상 클라이언트는 응답을 받은 뒤 다음 명령을 보냄
+    const client = async () => {
+        while (Date.now() < deadline) {
+            const groupId = groupIds[Math.floor(Math.random() * groupIds.length)];
+            const payload = PAYLOADS[Math.floor(Math.random() * PAYLOADS.length)];
+            samples.push(await sendCommand(agent, config.server, groupId, payload));
+        }
+    };
+    await Promise.all(Array.from({ length: config.concurrency }, client));
+
+    const elapsedMs = Date.now() - startedAt;
+    const failed = samples.filter((sample) => !sample.ok);
+    const errors = {};
+    for (const sample of failed) {
+        errors[sample.error] = (errors[sample.error] || 0) + 1;
+    }
+
+    const simulatorTotals = {};
+    for (const simulator of simulators) {
+        for (const [key, value] of Object.entries(simulator.stats)) {
+            simulatorTotals[key] = (simulatorTotals[key] || 0) + value;
+        }
+    }
+
+    const report = {
+        benchmark: 'load-test',
+        timestamp: new Date().toISOString(),
+        config: {
+            server: config.server,
+            devices: config.devices,
+            concurrency: config.concurrency,
+            duration_s: config.durationMs / 1000,
+            latency_ms: config.simulator.latencyMs,
+            jitter_ms: config.simulator.jitterMs,
+            airtime_ms: config.simulator.airtimeMs,
+            fail_rate: config.simulator.failRate,
+            drop_rate: config.simulator.dropRate
+        },
+        requests: samples.length,
+        succeeded: samples.length - failed.length,
+        failed: failed.length,
+        error_rate: samples.length ? Math.round((failed.length / samples.length) * 10000) / 10000 : 0,
+        throughput_rps: Math.round((samples.length / (elapsedMs / 1000)) * 100) / 100,
+        latency_ms: summarize(samples.map((sample) => sample.latency_ms)),
+        device_ms: summarize(samples.map((sample) => sample.device_ms)),
+        errors,
+        simulator: simulatorTotals
+    };
+
+    const output = JSON.stringify(report, null, 2);
+    console.log(output);
+    if (config.out) {
+        fs.writeFileSync(config.out, output + '\n');
+    }
+
+    agent.destroy();
+    await Promise.all(simulators.map((simulator) => simulator.stop()));
+    await cleanup();
+    await database.close();
+}
+
+run().catch((error) => {
+    console.error(error);
+    process.exit(1);
+});
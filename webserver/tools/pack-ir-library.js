@@ -0,0 +1,248 @@
+// IR 코드 라이브러리 패커
+// 사용법: node tools/pack-ir-library.js <입력.json> <출력.bin> [--upload http://<ESP32 IP>[:포트] --key <API 키>]
+// 출력 포맷은 firmware/main/ir_code_library.h 와 일치해야 한다.
+const fs = require('fs');
+const http = require('http');
+
+const MAGIC = 0x424C5249; // "IRLB"
+const VERSION = 1;
+const HEADER_SIZE = 40;
+const MODEL_SIZE = 16;
+const CODE_SIZE = 32;
+const NAME_MAX = 31; // 펌웨어 IR_MODEL_NAME_MAX - 1
+
+// aircon_command_t 순서
+const COMMANDS = [
+    'power_on', 'power_off',
+    'mode_cool', 'mode_heat', 'mode_fan',
+    'temp_up', 'temp_down',
+    'fan_speed_1', 'fan_speed_2', 'fan_speed_3'
+];
+
+const PROTOCOL_DEFAULTS = {
+    repeat: 3,
+    repeat_gap_ms: 100,
+    // 예약 필드: 펌웨어 송신부가 아직 사용하지 않음
+    carrier_khz: 38
+};
+
+const CRC_TABLE = (() => {
+    const table = new Uint32Array(256);
+    for (let n = 0; n < 256; n++) {
+        let c = n;
+        for (let k = 0; k < 8; k++) {
+            c = c & 1 ? 0xEDB88320 ^ (c >>> 1) : c >>> 1;
+        }
+        table[n] = c >>> 0;
+    }
+    return table;
+})();
+
+// esp_rom_crc32_le(0, ...) 와 같은 CRC32
+function crc32(buffer) {
+    let crc = 0xFFFFFFFF;
+    for (const byte of buffer) {
+        crc = CRC_TABLE[(crc ^ byte) & 0xFF] ^ (crc >>> 8);
+    }
+    return (crc ^ 0xFFFFFFFF) >>> 0;
+}
+
+function fail(message) {
+    throw new Error(message);
+}
+
+function resolveProtocol(library, model) {
+    const protocol = typeof model.protocol === 'string'
+        ? library.protocols && library.protocols[model.protocol]
+        : model.protocol;
+    if (!protocol) {
+        fail(`${model.brand} ${model.model}: 프로토콜을 찾을 수 없습니다 (${model.protocol})`);
+    }
+
+    const resolved = { ...PROTOCOL_DEFAULTS, ...protocol };
+    for (const field of ['bits', 'header_mark', 'header_space', 'bit_mark', 'one_space', 'zero_space', 'trailer_mark']) {
+        if (!Number.isInteger(resolved[field]) || resolved[field] < 0 || resolved[field] > 0xFFFF) {
+            fail(`${model.brand} ${model.model}: 프로토콜 필드 ${field} 값이 잘못되었습니다`);
+        }
+    }
+    if (resolved.bits < 1 || resolved.bits > 64) {
+        fail(`${model.brand} ${model.model}: bits는 1~64 사이여야 합니다`);
+    }
+    return resolved;
+}
+
+function pack(library) {
+    if (!Array.isArray(library.models) || library.models.length === 0) {
+        fail('models 배열이 비어 있습니다');
+    }
+
+    // 펌웨어의 strcmp 이진 탐색과 같은 순서(바이트 단위 brand, model)로 정렬
+    const models = library.models.map((model) => {
+        for (const field of ['brand', 'model']) {
+            if (typeof model[field] !== 'string' || Buffer.byteLength(model[field]) > NAME_MAX) {
+                fail(`모델 ${field}는 ${NAME_MAX}바이트 이하 문자열이어야 합니다: ${model[field]}`);
+            }
+        }
+        return { ...model, brandBytes: Buffer.from(model.brand), modelBytes: Buffer.from(model.model) };
+    }).sort((a, b) => Buffer.compare(a.brandBytes, b.brandBytes) || Buffer.compare(a.modelBytes, b.modelBytes));
+
+    for (let i = 1; i < models.length; i++) {
+        if (Buffer.compare(models[i - 1].brandBytes, models[i].brandBytes) === 0 &&
+            Buffer.compare(models[i - 1].modelBytes, models[i].modelBytes) === 0) {
+            fail(`중복된 모델: ${models[i].brand} ${models[i].model}`);
+        }
+    }
+
+    // 문자열 테이블 (중복 제거)
+    const strings = new Map();
+    const stringChunks = [];
+    let stringsSize = 0;
+    const intern = (bytes) => {
+        const key = bytes.toString('hex');
+        if (!strings.has(key)) {
+            strings.set(key, stringsSize);
+            stringChunks.push(bytes, Buffer.alloc(1));
+            stringsSize += bytes.length + 1;
+        }
+        return strings.get(key);
+    };
+
+    const modelEntries = [];
+    const codeEntries = [];
+    for (const model of models) {
+        const protocol = resolveProtocol(library, model);
+        const codes = Object.entries(model.codes || {}).map(([name, value]) => {
+            const command = COMMANDS.indexOf(name);
+            if (command < 0) {
+                fail(`${model.brand} ${model.model}: 알 수 없는 명령 ${name}`);
+            }
+            const code = BigInt(value);
+            if (code < 0n || code >= (1n << BigInt(protocol.bits))) {
+                fail(`${model.brand} ${model.model}: ${name} 코드가 ${protocol.bits}비트를 넘습니다`);
+            }
+            return { command, code };
+        }).sort((a, b) => a.command - b.command);
+
+        modelEntries.push({
+            brandOffset: intern(model.brandBytes),
+            modelOffset: intern(model.modelBytes),
+            firstCode: codeEntries.length,
+            codeCount: codes.length
+        });
+        for (const code of codes) {
+            codeEntries.push({ ...code, protocol });
+        }
+    }
+
+    const modelsOffset = HEADER_SIZE;
+    const codesOffset = modelsOffset + modelEntries.length * MODEL_SIZE;
+    const stringsOffset = codesOffset + codeEntries.length * CODE_SIZE;
+    const totalSize = stringsOffset + stringsSize;
+    const buffer = Buffer.alloc(totalSize);
+
+    modelEntries.forEach((entry, index) => {
+        const offset = modelsOffset + index * MODEL_SIZE;
+        buffer.writeUInt32LE(entry.brandOffset, offset);
+        buffer.writeUInt32LE(entry.modelOffset, offset + 4);
+        buffer.writeUInt32LE(entry.firstCode, offset + 8);
+        buffer.writeUInt16LE(entry.codeCount, offset + 12);
+    });
+
+    codeEntries.forEach((entry, index) => {
+        const offset = codesOffset + index * CODE_SIZE;
+        const p = entry.protocol;
+        buffer.writeBigUInt64LE(entry.code, offset);
+        buffer.writeUInt16LE(entry.command, offset + 8);
+        buffer.writeUInt8(p.bits, offset + 10);
+        buffer.writeUInt8(p.repeat, offset + 11);
+        buffer.writeUInt16LE(p.header_mark, offset + 12);
+        buffer.writeUInt16LE(p.header_space, offset + 14);
+        buffer.writeUInt16LE(p.bit_mark, offset + 16);
+        buffer.writeUInt16LE(p.one_space, offset + 18);
+        buffer.writeUInt16LE(p.zero_space, offset + 20);
+        buffer.writeUInt16LE(p.trailer_mark, offset + 22);
+        buffer.writeUInt16LE(p.repeat_gap_ms, offset + 24);
+        buffer.writeUInt8(p.carrier_khz, offset + 26);
+    });
+
+    Buffer.concat(stringChunks).copy(buffer, stringsOffset);
+
+    buffer.writeUInt32LE(MAGIC, 0);
+    buffer.writeUInt16LE(VERSION, 4);
+    buffer.writeUInt16LE(HEADER_SIZE, 6);
+    buffer.writeUInt32LE(modelEntries.length, 8);
+    buffer.writeUInt32LE(modelsOffset, 12);
+    buffer.writeUInt32LE(codeEntries.length, 16);
+    buffer.writeUInt32LE(codesOffset, 20);
+    buffer.writeUInt32LE(stringsOffset, 24);
+    buffer.writeUInt32LE(stringsSize, 28);
+    buffer.writeUInt32LE(totalSize, 32);
+    buffer.writeUInt32LE(crc32(buffer.subarray(HEADER_SIZE)), 36);
+
+    return { buffer, models: modelEntries.length, codes: codeEntries.length };
+}
+
+function upload(target, apiKey, buffer) {
+    const url = new URL('/api/ir/library', target);
+
+    return new Promise((resolve, reject) => {
+        const req = http.request(url, {
+            method: 'POST',
+            headers: {
+                'Authorization': `Bearer ${apiKey}`,
+                'Content-Type': 'application/octet-stream',
+                'Content-Length': buffer.length
+            }
+        }, (res) => {
+            let body = '';
+            res.on('data', (chunk) => { body += chunk; });
+            res.on('end', () => {
+                if (res.statusCode === 200) {
+                    resolve(body);
+                } else {
+                    reject(new Error(`업로드 실패 (HTTP ${res.statusCode}): ${body}`));
+                }
+            });
+        });
+        req.on('error', reject);
+        req.end(buffer);
+    });
+}
+
+async function main() {
+    const args = process.argv.slice(2);
+    const option = (name) => {
+        const index = args.indexOf(name);
+        return index >= 0 ? args.splice(index, 2)[1] : undefined;
+    };
+    const target = option('--upload');
+    const apiKey = option('--key') || process.env.DEFAULT_ESP32_API_KEY;
+    const [input, output] = args;
+
+    if (!input) {
+        console.error('사용법: node tools/pack-ir-library.js <입력.json> <출력.bin> [--upload http://<IP> --key <API 키>]');
+        process.exit(1);
+    }
+
+    const library = JSON.parse(fs.readFileSync(input, 'utf8'));
+    const result = pack(library);
+    console.log(`모델 ${result.models}개, 코드 ${result.codes}개, ${result.buffer.length} 바이트`);
+
+    if (output) {
+        fs.writeFileSync(output, result.buffer);
+        console.log(`저장: ${output}`);
+    }
+
+    if (target) {
+        console.log(await upload(target, apiKey, result.buffer));
+    }
+}
+
+if (require.main === module) {
+    main().catch((error) => {
+        console.error(error.message);
+        process.exit(1);
+    });
+}
+
+module.exports = { pack, crc32, COMMANDS };